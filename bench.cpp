@@ -0,0 +1,114 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+#include <iostream>
+#include "src/json.h"
+#include "src/ListingParser.h"
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace Swift;
+
+/**
+ * Compares the jsoncpp DOM with ListingParser on a generated container
+ * listing. Usage: bench [number of entries, default 1000000]
+ */
+
+static string makeListing(uint64_t _entries) {
+  ostringstream listing;
+  listing << "[";
+  for (uint64_t i = 0; i < _entries; i++) {
+    if (i > 0)
+      listing << ", ";
+    listing << "{\"hash\": \"d41d8cd98f00b204e9800998ecf8427e\", "
+        << "\"last_modified\": \"2014-12-01T10:33:27.581850\", "
+        << "\"bytes\": " << i * 37 << ", \"name\": \"dir/object_" << i
+        << "\", \"content_type\": \"application/octet-stream\"}";
+  }
+  listing << "]";
+  return listing.str();
+}
+
+struct Entry {
+  string name;
+  uint64_t bytes;
+  string contentType;
+  string hash;
+  string lastModified;
+};
+
+int main(int argc, char** argv) {
+  uint64_t entries = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  string listing = makeListing(entries);
+  cout << "Listing of " << entries << " entries, " << listing.size()
+      << " bytes" << endl;
+
+  //jsoncpp: the path swiftGetObjects used to take
+  {
+    auto start = chrono::steady_clock::now();
+    istringstream input(listing);
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(input, root, false)) {
+      cout << reader.getFormattedErrorMessages() << endl;
+      return 1;
+    }
+    vector<Entry> result;
+    for (unsigned int i = 0; i < root.size(); i++) {
+      Entry entry;
+      entry.name = root[i].get("name", "").asString();
+      entry.bytes = root[i].get("bytes", -1).asInt64();
+      entry.contentType = root[i].get("content_type", "").asString();
+      entry.hash = root[i].get("hash", "").asString();
+      entry.lastModified = root[i].get("last_modified", "").asString();
+      result.push_back(entry);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "jsoncpp:       " << result.size() << " entries in "
+        << elapsed.count() << "s" << endl;
+  }
+
+  //ListingParser
+  {
+    auto start = chrono::steady_clock::now();
+    istringstream input(listing);
+    vector<Entry> result;
+    string error;
+    bool parsed = ListingParser::parse(input, [&](const ListingEntry &_entry) {
+      Entry entry;
+      entry.name = _entry.name;
+      entry.bytes = _entry.bytes;
+      entry.contentType = _entry.contentType;
+      entry.hash = _entry.hash;
+      entry.lastModified = _entry.lastModified;
+      result.push_back(entry);
+      return true;
+    }, error);
+    if (!parsed) {
+      cout << error << endl;
+      return 1;
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "ListingParser: " << result.size() << " entries in "
+        << elapsed.count() << "s" << endl;
+  }
+  return 0;
+}
@@ -18,9 +18,17 @@
 **************************************************************************/
 
 #include "Account.h"
+#include "ArchiveUpload.h"
+#include "BulkDelete.h"
 #include "Container.h"
 #include "HTTPIO.h"
+#include "Executor.h"
+#include "ListingParser.h"
+#include <Poco/DateTime.h>
+#include <Poco/DateTimeFormat.h>
+#include <Poco/DateTimeParser.h>
 #include <Poco/Exception.h>
+#include <Poco/NumberParser.h>
 #include <sstream>
 using namespace std;
 using namespace Poco;
@@ -29,7 +37,7 @@ using namespace Poco::Net;
 namespace Swift {
 
 /** Initialize Static members **/
-uint32_t Account::numOfCalls = 0;
+std::atomic<uint32_t> Account::numOfCalls(0);
 
 struct Role {
   string name = "null";
@@ -49,9 +57,13 @@ struct Role {
 };
 
 Account::~Account() {
-  //Delete Token
-  delete token;
-  token = nullptr;
+  //A background HEAD may still be using this account
+  {
+    unique_lock<mutex> lock(statsMutex);
+    while (stats.refreshing)
+      statsRefreshed.wait(lock);
+  }
+  //Token is released with the last holder
   //Delete roles
   for(Role* role:roles) {
     delete role;
@@ -69,7 +81,8 @@ Account::~Account() {
 
 Account::Account() :
     userID(""), name(""), token(nullptr), allowReauthenticate(false), preferredRegion(
-        ""), delimiter('/') {
+        ""), delimiter('/'), maxDeletesPerRequest(0),
+    bulkDeleteSupported(false) {
   // TODO Auto-generated constructor stub
 
 }
@@ -156,7 +169,7 @@ SwiftResult<Account*>* Account::authenticate(
   }
   //Parse Token
   Json::Value tokenRoot = root.get("token", Json::nullValue);
-  instance->token = Token::fromJSON(tokenRoot);
+  instance->token = shared_ptr<Token>(Token::fromJSON(tokenRoot));
   //Parse Service Information
   Json::Value serviceRoot = root.get("serviceCatalog", Json::nullValue);
   if (serviceRoot != Json::nullValue)
@@ -178,19 +191,122 @@ SwiftResult<Account*>* Account::authenticate(
   return result;
 }
 
+bool Account::refreshStats() {
+  SwiftResult<int*> *head = swiftShowMetadata();
+  bool ok = head->getError().code == SWIFT_OK.code;
+  StatsCache fetched;
+  fetched.fetchedAt = chrono::steady_clock::now();
+  if (ok) {
+    HTTPResponse *response = head->getResponse();
+    Int64 value;
+    if (NumberParser::tryParse64(response->get("X-Account-Bytes-Used", ""),
+        value))
+      fetched.bytesUsed = value;
+    if (NumberParser::tryParse64(response->get("X-Account-Object-Count", ""),
+        value))
+      fetched.objectCount = value;
+    /**
+     * Date is the time of the response; X-Timestamp is when the account was
+     * created and only used if a proxy dropped Date.
+     */
+    DateTime date;
+    int timeZone;
+    double timestamp;
+    if (DateTimeParser::tryParse(DateTimeFormat::HTTP_FORMAT,
+        response->get("Date", ""), date, timeZone))
+      fetched.serverTime = date.timestamp().epochMicroseconds() / 1000;
+    else if (NumberParser::tryParseFloat(response->get("X-Timestamp", ""),
+        timestamp))
+      fetched.serverTime = (int64_t) (timestamp * 1000);
+  }
+  delete head;
+
+  lock_guard<mutex> guard(statsMutex);
+  //A failed HEAD keeps the old values, but they are no longer fresh
+  if (ok) {
+    fetched.valid = true;
+    fetched.refreshing = stats.refreshing;
+    fetched.background = stats.background;
+    fetched.ttl = stats.ttl;
+    stats = fetched;
+  }
+  return ok;
+}
+
+Account::StatsCache Account::getStats() {
+  unique_lock<mutex> lock(statsMutex);
+  while (true) {
+    bool fresh = stats.valid
+        && chrono::steady_clock::now() - stats.fetchedAt < stats.ttl;
+    if (fresh)
+      return stats;
+    //Stale but usable: refresh behind the caller's back
+    if (stats.valid && stats.background) {
+      if (!stats.refreshing) {
+        stats.refreshing = true;
+        Executor::getDefault().execute([this]() {
+          refreshStats();
+          lock_guard<mutex> guard(statsMutex);
+          stats.refreshing = false;
+          statsRefreshed.notify_all();
+        });
+      }
+      return stats;
+    }
+    //Someone else is fetching; share their HEAD
+    if (stats.refreshing) {
+      statsRefreshed.wait(lock);
+      //Give up rather than loop if that HEAD failed
+      if (!stats.valid)
+        return stats;
+      continue;
+    }
+    stats.refreshing = true;
+    lock.unlock();
+    refreshStats();
+    lock.lock();
+    stats.refreshing = false;
+    statsRefreshed.notify_all();
+    return stats;
+  }
+}
+
 long Account::getBytesUsed() {
-  //TODO implement
-  return -1;
+  return getStats().bytesUsed;
 }
 
 int Account::getObjectCount() {
-  //TODO implement
-  return -1;
+  return getStats().objectCount;
 }
 
 long Account::getServerTime() {
-  //TODO implement
-  return -1;
+  StatsCache snapshot = getStats();
+  if (snapshot.serverTime < 0)
+    return -1;
+  return snapshot.serverTime
+      + chrono::duration_cast<chrono::milliseconds>(
+          chrono::steady_clock::now() - snapshot.fetchedAt).count();
+}
+
+void Account::setStatsTTL(std::chrono::milliseconds _ttl) {
+  lock_guard<mutex> guard(statsMutex);
+  stats.ttl = _ttl;
+}
+
+void Account::setStatsBackgroundRefresh(bool _background) {
+  {
+    lock_guard<mutex> guard(statsMutex);
+    stats.background = _background;
+    if (!_background || stats.valid || stats.refreshing)
+      return;
+    stats.refreshing = true;
+  }
+  Executor::getDefault().execute([this]() {
+    refreshStats();
+    lock_guard<mutex> guard(statsMutex);
+    stats.refreshing = false;
+    statsRefreshed.notify_all();
+  });
 }
 
 void Account::setAllowReauthenticate(bool _allowReauthenticate) {
@@ -209,12 +325,26 @@ uint32_t Account::getNumberOfCalls() {
   return Account::numOfCalls;
 }
 
-Tenant* Account::getTenant() {
-  return this->token->getTenant();
+shared_ptr<Tenant> Account::getTenant() const {
+  shared_ptr<Token> current = getToken();
+  if (!current)
+    return nullptr;
+  //Shares ownership of the token the tenant belongs to
+  return shared_ptr<Tenant>(current, current->getTenant());
+}
+
+shared_ptr<Token> Account::getToken() const {
+  return atomic_load(&token);
 }
 
-Token* Account::getToken() {
-  return this->token;
+string Account::getTokenID() const {
+  shared_ptr<Token> current = getToken();
+  return current ? current->getId() : "";
+}
+
+string Account::getUserID() const {
+  lock_guard<mutex> guard(tokenMutex);
+  return userID;
 }
 
 Service* Account::getSwiftService() {
@@ -249,9 +379,11 @@ string Account::toString() {
   }
   serviceStream << "}";
 
-  Json::Value* tokenJSON = Token::toJSON(*this->token);
+  shared_ptr<Token> currentToken = getToken();
+  Json::Value* tokenJSON = currentToken ? Token::toJSON(*currentToken)
+      : new Json::Value();
 
-  output << "userID:" << userID << ",\n" << "name:" << name << ",\n"
+  output << "userID:" << getUserID() << ",\n" << "name:" << name << ",\n"
       << "username:" << authInfo.username << ",\n" << "password:"
       << authInfo.password << ",\n" << "authUrl:" << authInfo.authUrl << ",\n"
       << "allowReauthenticate:" << allowReauthenticate << ",\n"
@@ -268,6 +400,13 @@ string Account::toString() {
 
 SwiftResult<istream*>* Account::swiftAccountDetails(HTTPHeader &_formatHeader,
     vector<HTTPHeader> *_reqMap, bool _newest)
+{
+  return swiftAccountDetails(ListingQuery().format(_formatHeader.getValue()),
+      _reqMap, _newest);
+}
+
+SwiftResult<istream*>* Account::swiftAccountDetails(const ListingQuery &_query,
+    vector<HTTPHeader> *_reqMap, bool _newest)
 {
   /**
    * Check HTTP return code
@@ -286,30 +425,18 @@ SwiftResult<istream*>* Account::swiftAccountDetails(HTTPHeader &_formatHeader,
   validHTTPCodes.push_back(HTTPResponse::HTTP_NO_CONTENT);
 
   //add X-Newest
-  bool shouldDelete = false;
-  if (_newest) {
-    if(_reqMap == nullptr) {
-      _reqMap = new vector<HTTPHeader>();
-      shouldDelete = true;
-    }
-    _reqMap->push_back(*new HTTPHeader("X-Newest", "True"));
-  }
+  vector<HTTPHeader> reqMap;
+  if (_reqMap != nullptr)
+    reqMap = *_reqMap;
+  if (_newest)
+    reqMap.push_back(HTTPHeader("X-Newest", "True"));
 
-  vector<HTTPHeader> uriParams;
-  uriParams.push_back(_formatHeader);
+  vector<HTTPHeader> uriParams = _query.toParams();
 
   //Do swift transaction
   string path = "";
-  SwiftResult<istream*> *result = doSwiftTransaction<istream*>(this, path,
-          HTTPRequest::HTTP_GET, &uriParams, _reqMap, &validHTTPCodes, nullptr, 0,
-            nullptr);
-  if(!shouldDelete)
-    return result;
-  else {
-    delete _reqMap;
-    return result;
-  }
-
+  return doSwiftTransaction<istream*>(this, path, HTTPRequest::HTTP_GET,
+      &uriParams, &reqMap, &validHTTPCodes, nullptr, 0, nullptr);
 }
 
 SwiftResult<int*>* Account::swiftCreateMetadata(
@@ -401,34 +528,27 @@ SwiftResult<vector<Container>*>* Account::swiftGetContainers(bool _newest) {
     return result;
   }
 
-  //Parse JSON
-  Json::Value root;   // will contains the root value after parsing.
-  Json::Reader reader;
-  bool parsingSuccessful = reader.parse(*accountDetail->getPayload(), root, false);
+  //Allocate containers
+  vector<Container>*containers = new vector<Container>();
+  //Parse JSON as it streams in
+  string parseError;
+  bool parsingSuccessful = ListingParser::parse(*accountDetail->getPayload(),
+      [&](const ListingEntry &_entry) {
+        Container container(this, _entry.name);
+        container.setBytesUsed(_entry.bytes);
+        container.setTotalObjects(_entry.count);
+        containers->push_back(container);
+        return true;
+      }, parseError);
   if (!parsingSuccessful) {
-    SwiftError error(SwiftError::SWIFT_JSON_PARSE_ERROR,
-        reader.getFormattedErrorMessages());
+    SwiftError error(SwiftError::SWIFT_JSON_PARSE_ERROR, parseError);
     result->setError(error);
     result->setPayload(nullptr);
+    delete containers;
     delete accountDetail;
     return result;
   }
 
-  //Allocate containers
-  vector<Container>*containers = new vector<Container>();
-  //Successful parse
-  for(unsigned int i=0;i<root.size();i++) {
-    string name = root[i].get("name","").asString();
-    string count = root[i].get("count","").asString();
-    string bytes = root[i].get("bytes","").asString();
-
-    Container container(this,name);
-    container.setBytesUsed(stoul(bytes));
-    container.setTotalObjects(stoul(count));
-
-    containers->push_back(container);
-  }
-
   //Set payload
   result->setPayload(containers);
   delete accountDetail;
@@ -454,9 +574,143 @@ SwiftResult<int*>* Account::swiftShowMetadata(bool _newest) {
         nullptr);
 }
 
+SwiftResult<istream*>* Account::swiftGetInfo() {
+  Service* swiftService = getSwiftService();
+  if (swiftService == nullptr)
+    return returnNullError<istream*>("SWIFT Service");
+  Endpoint* swiftEndpoint = swiftService->getFirstEndpoint();
+  if (swiftEndpoint == nullptr)
+    return returnNullError<istream*>("SWIFT Endpoint");
+
+  //info is served at the root of the proxy, not under the account
+  URI uri(swiftEndpoint->getPublicUrl());
+  uri.setPath("/info");
+  uri.setRawQuery("");
+
+  SwiftResult<istream*> *result = new SwiftResult<istream*>();
+  result->setPayload(nullptr);
+  HTTPResponse *httpResponse = new HTTPResponse();
+  result->setResponse(httpResponse);
+  try {
+    HTTPClientSession *httpSession = doHTTPIO(uri, HTTPRequest::HTTP_GET,
+        nullptr);
+    result->setSession(httpSession);
+    increaseCallCounter();
+    istream &infoStream = httpSession->receiveResponse(*httpResponse);
+    if (httpResponse->getStatus() != HTTPResponse::HTTP_OK) {
+      string errorText = "Code:";
+      errorText += to_string(httpResponse->getStatus()) + "\tReason:"
+          + httpResponse->getReason();
+      result->setError(SwiftError(SwiftError::SWIFT_HTTP_ERROR, errorText));
+      return result;
+    }
+    result->setPayload(&infoStream);
+  } catch (Exception &e) {
+    result->setError(SwiftError(SwiftError::SWIFT_EXCEPTION, e.displayText()));
+  }
+  return result;
+}
+
+void Account::readBulkDeleteInfo(uint32_t &_maxDeletes, bool &_supported) {
+  //Racing threads may both ask, they get the same answer
+  _maxDeletes = 10000;
+  _supported = false;
+  bool answered = false;
+  SwiftResult<istream*> *info = swiftGetInfo();
+  if (info->getError().code == SWIFT_OK.code) {
+    Json::Value root;
+    Json::Reader reader;
+    if (reader.parse(*info->getPayload(), root, false) && root.isObject()) {
+      answered = true;
+      const Json::Value &bulkDelete = root["bulk_delete"];
+      _supported = bulkDelete.isObject();
+      if (_supported && bulkDelete["max_deletes_per_request"].isIntegral()
+          && bulkDelete["max_deletes_per_request"].asInt64() > 0)
+        _maxDeletes = bulkDelete["max_deletes_per_request"].asUInt();
+    }
+  }
+  //A proxy without /info will not grow one: no bulk delete either
+  else if (info->getResponse() != nullptr
+      && info->getResponse()->getStatus() == HTTPResponse::HTTP_NOT_FOUND)
+    answered = true;
+  delete info;
+  if (!answered)
+    return;
+  bulkDeleteSupported = _supported;
+  maxDeletesPerRequest = _maxDeletes;
+}
+
+uint32_t Account::getMaxDeletesPerRequest() {
+  uint32_t maxDeletes = maxDeletesPerRequest;
+  if (maxDeletes == 0) {
+    bool supported;
+    readBulkDeleteInfo(maxDeletes, supported);
+  }
+  return maxDeletes;
+}
+
+bool Account::isBulkDeleteSupported() {
+  if (maxDeletesPerRequest != 0)
+    return bulkDeleteSupported;
+  uint32_t maxDeletes;
+  bool supported;
+  readBulkDeleteInfo(maxDeletes, supported);
+  return supported;
+}
+
+void Account::setStatCache(chrono::milliseconds _positiveTTL,
+    chrono::milliseconds _negativeTTL, uint32_t _numShards) {
+  shared_ptr<StatCache> cache;
+  if (_positiveTTL.count() > 0)
+    cache = make_shared<StatCache>(_positiveTTL, _negativeTTL, _numShards);
+  atomic_store(&statCache, cache);
+}
+
+shared_ptr<StatCache> Account::getStatCache() const {
+  return atomic_load(&statCache);
+}
+
+SwiftResult<BulkDeleteResult*>* Account::swiftBulkDelete(
+    const vector<string> &_paths, uint32_t _parallelism) {
+  return BulkDelete::run(this, "", _paths, _parallelism);
+}
+
+SwiftResult<ArchiveUploadResult*>* Account::swiftUploadArchive(
+    const ArchiveEntrySource &_source, bool _gzip) {
+  return ArchiveUpload::run(this, "", _source, _gzip);
+}
+
+future<SwiftResult<vector<Container>*>*> Account::swiftGetContainersAsync(
+    bool _newest) {
+  return Executor::getDefault().submit([this, _newest]() {
+    return this->swiftGetContainers(_newest);
+  });
+}
+
+future<SwiftResult<istream*>*> Account::swiftAccountDetailsAsync(
+    HTTPHeader &_formatHeader, vector<HTTPHeader> *_reqMap, bool _newest) {
+  HTTPHeader formatHeader(_formatHeader);
+  shared_ptr<vector<HTTPHeader> > reqMap = copyHeaders(_reqMap);
+  return Executor::getDefault().submit(
+      [this, formatHeader, reqMap, _newest]() mutable {
+        return this->swiftAccountDetails(formatHeader, reqMap.get(), _newest);
+      });
+}
+
+future<SwiftResult<int*>*> Account::swiftShowMetadataAsync(bool _newest) {
+  return Executor::getDefault().submit([this, _newest]() {
+    return this->swiftShowMetadata(_newest);
+  });
+}
+
 } /* namespace Swift */
 
-bool Swift::Account::reAuthenticate() {
+bool Swift::Account::reAuthenticate(const std::string &_expiredTokenID) {
+  lock_guard<mutex> authGuard(authMutex);
+  //Another thread already replaced the expired token
+  if (!_expiredTokenID.empty() && getTokenID() != _expiredTokenID)
+    return true;
+
   //Use authenticate function
   SwiftResult<Account*> *tempAccount = authenticate(authInfo,true);
 
@@ -466,10 +720,13 @@ bool Swift::Account::reAuthenticate() {
     return false;
   }
 
-  //Parse User Info
-  this->userID = tempAccount->getPayload()->userID;
-  //Parse Token
-  *this->token = *tempAccount->getPayload()->token;
+  {
+    lock_guard<mutex> tokenGuard(tokenMutex);
+    //Parse User Info
+    this->userID = tempAccount->getPayload()->userID;
+  }
+  //Threads still using the old token keep it alive
+  atomic_store(&token, tempAccount->getPayload()->getToken());
 
   delete tempAccount;
   return true;
@@ -25,10 +25,19 @@
 #include "Authentication.h"
 #include "SwiftResult.h"
 #include "Header.h"
+#include "ListingQuery.h"
+#include "ArchiveUpload.h"
+#include "StatCache.h"
 #include "swiftcpp_export.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace Swift {
@@ -38,6 +47,7 @@ struct Role;
 
 /** Forward declare Container **/
 class Container;
+struct BulkDeleteResult;
 
 class SWIFTCPP_EXPORT Account
 {
@@ -54,9 +64,11 @@ private:
   std::string name;
 
   /**
-   * ObjectStore token
+   * ObjectStore token. Reauthentication swaps in a new one while other
+   * threads may hold the old one: read with atomic_load, replace with
+   * atomic_store.
    */
-  Token *token;
+  std::shared_ptr<Token> token;
 
   /**
    * Authentication Information
@@ -95,7 +107,68 @@ private:
   /**
    * Number of calls made to Object Store
    */
-  static uint32_t numOfCalls;
+  static std::atomic<uint32_t> numOfCalls;
+
+  /**
+   * Guards userID which is replaced on reauthentication while other
+   * threads are using it
+   */
+  mutable std::mutex tokenMutex;
+
+  /**
+   * Serializes reauthentication so concurrent 401s only fetch one token
+   */
+  std::mutex authMutex;
+
+  /**
+   * Account statistics from the last HEAD, shared by all readers
+   */
+  struct StatsCache {
+    int64_t bytesUsed = -1;
+    int64_t objectCount = -1;
+    /**
+     * Server time in milliseconds since 1970 when fetchedAt was taken
+     */
+    int64_t serverTime = -1;
+    std::chrono::steady_clock::time_point fetchedAt;
+    bool valid = false;
+    bool refreshing = false;
+    bool background = false;
+    std::chrono::milliseconds ttl = std::chrono::milliseconds(10000);
+  } stats;
+
+  /**
+   * Guards stats; statsRefreshed is notified when a HEAD completes
+   */
+  std::mutex statsMutex;
+  std::condition_variable statsRefreshed;
+
+  /**
+   * Returns a snapshot of stats, fetching or refreshing them as needed
+   */
+  StatsCache getStats();
+
+  /**
+   * max_deletes_per_request of the bulk middleware, 0 until /info was read
+   */
+  std::atomic<uint32_t> maxDeletesPerRequest;
+
+  /**
+   * Whether /info lists the bulk delete middleware
+   */
+  std::atomic<bool> bulkDeleteSupported;
+
+  /**
+   * Object HEAD cache, nullptr unless turned on; read with atomic_load
+   */
+  std::shared_ptr<StatCache> statCache;
+
+  /**
+   * Reads the bulk delete capabilities from /info into _maxDeletes and
+   * _supported. They are remembered only if /info gave an answer, so a
+   * transient failure is retried on the next call.
+   */
+  void readBulkDeleteInfo(uint32_t &_maxDeletes, bool &_supported);
 
 public:
   virtual ~Account();
@@ -110,26 +183,55 @@ public:
   static SwiftResult<Account*>* authenticate(
       const AuthenticationInfo &_authInfo, bool _allowReauthenticate = true);
 
-  bool reAuthenticate();
+  /**
+   * Gets a new token for this account. Safe to call from several threads at
+   * once; if _expiredTokenID is given and the token has already been
+   * replaced by another thread, no new authentication request is made.
+   * @return whether a valid token is available
+   */
+  bool reAuthenticate(const std::string &_expiredTokenID = "");
 
   /**
    * The number of bytes stored by the StoredObjects in all Containers in the Account.
-   * @return number of bytes
+   * Read from a cached HEAD of the account, see setStatsTTL().
+   * @return number of bytes, -1 if the account could not be read
    */
   long getBytesUsed();
 
   /**
    * The number of StoredObjects in all Containers in the Account.
-   * @return number of StoredObjects
+   * Read from a cached HEAD of the account, see setStatsTTL().
+   * @return number of StoredObjects, -1 if the account could not be read
    */
   int getObjectCount();
 
   /**
-   * Returns the server time in milliseconds since 1970
-   * @return server time
+   * Returns the server time in milliseconds since 1970, from the Date of
+   * the cached HEAD plus the time elapsed since.
+   * @return server time, -1 if the account could not be read
    */
   long getServerTime();
 
+  /**
+   * How long the HEAD behind the statistics getters is reused (default
+   * 10 seconds). Concurrent readers of an expired value wait for a single
+   * HEAD instead of sending one each.
+   */
+  void setStatsTTL(std::chrono::milliseconds _ttl);
+
+  /**
+   * With background refresh on, an expired value is still returned at once
+   * while one HEAD refreshes it on Executor::getDefault(); getters only
+   * block until the very first HEAD. Turning it on starts that HEAD.
+   */
+  void setStatsBackgroundRefresh(bool _background);
+
+  /**
+   * HEADs the account now and updates the statistics cache.
+   * @return whether the HEAD succeeded
+   */
+  bool refreshStats();
+
   void setAllowReauthenticate(bool _allowReauthenticate);
 
   /**
@@ -152,16 +254,29 @@ public:
   static uint32_t getNumberOfCalls();
 
   /**
-   * Returns the tenant of the account.
+   * Returns the tenant of the account. It stays valid, with the token it
+   * belongs to, as long as the returned pointer is held.
    * @return the tenant belonging to the Account
    */
-  Tenant* getTenant();
+  std::shared_ptr<Tenant> getTenant() const;
 
   /**
-   * Returns the tenant of the account.
-   * @return the tenant belonging to the Account
+   * Returns the current token of the account. Reauthentication replaces
+   * the account's token instead of changing this one.
+   * @return the token of the Account
    */
-  Token* getToken();
+  std::shared_ptr<Token> getToken() const;
+
+  /**
+   * Returns a copy of the current token ID
+   * @return the current token ID
+   */
+  std::string getTokenID() const;
+
+  /**
+   * Returns a copy of the ID of the authenticated user
+   */
+  std::string getUserID() const;
 
   /**
    * String representation of this class
@@ -198,14 +313,21 @@ public:
    * _formatHeader
    *  Specifies format of returned information
    * _reqMap
-   *  You can add additional query parameters to this request. Please refer
-   *  the Swift API documentations to see available query parameters.
+   *  Additional request headers. Query parameters go through the
+   *  ListingQuery overload.
    *  http://docs.openstack.org/api/openstack-object-storage/1.0/content/index.html
    */
   SwiftResult<std::istream*>* swiftAccountDetails(HTTPHeader &_formatHeader =
       HEADER_FORMAT_APPLICATION_JSON,
       std::vector<HTTPHeader> *_reqMap = nullptr, bool _newest = false);
 
+  /**
+   * Same as above with the containers filtered by _query (prefix, marker,
+   * end_marker, limit, ...) on the server.
+   */
+  SwiftResult<std::istream*>* swiftAccountDetails(const ListingQuery &_query,
+      std::vector<HTTPHeader> *_reqMap = nullptr, bool _newest = false);
+
   /**
    * Adds metadata to this account
    * @return
@@ -246,6 +368,82 @@ public:
    *  part of httpresponse. For example, getResponse()->write(cout);
    */
   SwiftResult<int*>* swiftShowMetadata(bool _newest = false);
+
+  /**
+   * Gets the capabilities of the cluster (GET /info on the proxy); no
+   * token is needed.
+   * @return
+   *  A json stream, e.g. {"swift": {...}, "bulk_delete": {...}, ...}
+   */
+  SwiftResult<std::istream*>* swiftGetInfo();
+
+  /**
+   * Number of names accepted by one bulk delete request. Read from /info
+   * on first use; 10000, the middleware default, if it is not advertised.
+   */
+  uint32_t getMaxDeletesPerRequest();
+
+  /**
+   * Whether /info advertises bulk delete; false if /info cannot be read
+   * right now, in which case the next call asks again.
+   */
+  bool isBulkDeleteSupported();
+
+  /**
+   * Turns on a stat cache for the objects of this account (see StatCache):
+   * Object::swiftShowMetadata and Object::swiftStat without X-Newest are
+   * answered from it. A new call replaces the cache, a zero _positiveTTL
+   * turns it off.
+   * _negativeTTL
+   *  How long a 404 is remembered
+   */
+  void setStatCache(std::chrono::milliseconds _positiveTTL,
+      std::chrono::milliseconds _negativeTTL = std::chrono::milliseconds(1000),
+      uint32_t _numShards = 16);
+
+  /**
+   * The stat cache, nullptr if it is off
+   */
+  std::shared_ptr<StatCache> getStatCache() const;
+
+  /**
+   * Deletes objects and empty containers with as few requests as possible,
+   * see BulkDelete.
+   * _paths
+   *  "container/object" or "container" names, not encoded.
+   * _parallelism
+   *  Number of bulk delete requests in flight at once.
+   * @return
+   *  Per name counts and failures. The payload is set even when the error
+   *  is not SWIFT_OK; it then covers the batches which went through.
+   */
+  SwiftResult<BulkDeleteResult*>* swiftBulkDelete(
+      const std::vector<std::string> &_paths, uint32_t _parallelism = 4);
+
+  /**
+   * Stores the entries of _source, named "container/object", with a single
+   * extract-archive request; missing containers are created. See
+   * ArchiveUpload.
+   */
+  SwiftResult<ArchiveUploadResult*>* swiftUploadArchive(
+      const ArchiveEntrySource &_source, bool _gzip = false);
+
+  /** Asynchronous API Functions **/
+
+  /**
+   * The ...Async functions run their blocking counterpart on
+   * Executor::getDefault() and return at once. Request parameters are
+   * copied; this Account must stay valid until the future is ready. The
+   * caller owns the SwiftResult returned by the future.
+   */
+  std::future<SwiftResult<std::vector<Container>*>*> swiftGetContainersAsync(
+      bool _newest = false);
+
+  std::future<SwiftResult<std::istream*>*> swiftAccountDetailsAsync(
+      HTTPHeader &_formatHeader = HEADER_FORMAT_APPLICATION_JSON,
+      std::vector<HTTPHeader> *_reqMap = nullptr, bool _newest = false);
+
+  std::future<SwiftResult<int*>*> swiftShowMetadataAsync(bool _newest = false);
 };
 
 } /* namespace Swift */
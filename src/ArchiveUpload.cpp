@@ -0,0 +1,261 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ArchiveUpload.h"
+#include "HTTPIO.h"
+#include "json.h"
+#include <Poco/DeflatingStream.h>
+#include <Poco/Exception.h>
+#include <Poco/URI.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+static const size_t TAR_BLOCK_SIZE = 512;
+
+/**
+ * Writes _value as a NUL terminated octal number filling _length bytes
+ */
+static void writeOctal(char *_field, size_t _length, uint64_t _value) {
+  snprintf(_field, _length, "%0*llo", (int) _length - 1,
+      (unsigned long long) _value);
+}
+
+static void writeHeader(ostream &_out, const string &_name,
+    const string &_prefix, char _type, uint64_t _size, int64_t _mtime) {
+  char header[TAR_BLOCK_SIZE];
+  memset(header, 0, sizeof(header));
+  memcpy(header, _name.data(), min<size_t>(_name.size(), 100));
+  writeOctal(header + 100, 8, 0644);
+  writeOctal(header + 108, 8, 0);
+  writeOctal(header + 116, 8, 0);
+  writeOctal(header + 124, 12, _size);
+  writeOctal(header + 136, 12, _mtime);
+  header[156] = _type;
+  memcpy(header + 257, "ustar", 6);
+  memcpy(header + 263, "00", 2);
+  memcpy(header + 345, _prefix.data(), min<size_t>(_prefix.size(), 155));
+
+  //The checksum is computed with its own field set to spaces
+  memset(header + 148, ' ', 8);
+  uint32_t checksum = 0;
+  for (size_t i = 0; i < TAR_BLOCK_SIZE; i++)
+    checksum += (unsigned char) header[i];
+  snprintf(header + 148, 8, "%06o", checksum);
+  header[155] = ' ';
+  _out.write(header, sizeof(header));
+}
+
+static void writePadding(ostream &_out, uint64_t _size) {
+  static const char zeros[TAR_BLOCK_SIZE] = { 0 };
+  size_t remainder = _size % TAR_BLOCK_SIZE;
+  if (remainder > 0)
+    _out.write(zeros, TAR_BLOCK_SIZE - remainder);
+}
+
+/**
+ * pax record "<length> <key>=<value>\n", the length counting itself
+ */
+static string paxRecord(const string &_key, const string &_value) {
+  string record = " " + _key + "=" + _value + "\n";
+  size_t length = record.size();
+  while (to_string(length).size() + record.size() != length)
+    length = to_string(length).size() + record.size();
+  return to_string(length) + record;
+}
+
+/**
+ * Largest size the 12 byte ustar field holds: 11 octal digits
+ */
+static const uint64_t USTAR_MAX_SIZE = (1ULL << 33) - 1;
+
+void ArchiveUpload::writeEntry(ostream &_out, const ArchiveEntry &_entry,
+    int64_t _mtime) {
+  const string &name = _entry.name;
+  string ustarName = name;
+  string ustarPrefix;
+  string paxRecords;
+  if (name.size() > 100) {
+    //Split at a '/' into prefix (155 bytes) and name (100 bytes) if we can
+    bool split = false;
+    for (size_t slash = name.find('/'); slash != string::npos && slash <= 155;
+        slash = name.find('/', slash + 1))
+      if (name.size() - slash - 1 <= 100 && slash + 1 < name.size()) {
+        ustarPrefix = name.substr(0, slash);
+        ustarName = name.substr(slash + 1);
+        split = true;
+        break;
+      }
+
+    if (!split) {
+      paxRecords += paxRecord("path", name);
+      ustarName = name.substr(name.size() - 100);
+    }
+  }
+  //Entries of 8GB and more only fit in a pax record
+  uint64_t ustarSize = _entry.size;
+  if (_entry.size > USTAR_MAX_SIZE) {
+    paxRecords += paxRecord("size", to_string(_entry.size));
+    ustarSize = 0;
+  }
+  if (!paxRecords.empty()) {
+    writeHeader(_out, "PaxHeader", "", 'x', paxRecords.size(), _mtime);
+    _out.write(paxRecords.data(), paxRecords.size());
+    writePadding(_out, paxRecords.size());
+  }
+  writeHeader(_out, ustarName, ustarPrefix, '0', ustarSize, _mtime);
+  if (_entry.size > 0)
+    _out.write(_entry.data, _entry.size);
+  writePadding(_out, _entry.size);
+}
+
+void ArchiveUpload::writeEnd(ostream &_out) {
+  static const char zeros[2 * TAR_BLOCK_SIZE] = { 0 };
+  _out.write(zeros, sizeof(zeros));
+}
+
+SwiftResult<ArchiveUploadResult*>* ArchiveUpload::run(Account *_account,
+    const string &_path, const ArchiveEntrySource &_source, bool _gzip) {
+  if (_account == nullptr)
+    return returnNullError<ArchiveUploadResult*>("account");
+  Service* swiftService = _account->getSwiftService();
+  if (swiftService == nullptr)
+    return returnNullError<ArchiveUploadResult*>("SWIFT Service");
+  Endpoint* swiftEndpoint = swiftService->getFirstEndpoint();
+  if (swiftEndpoint == nullptr)
+    return returnNullError<ArchiveUploadResult*>("SWIFT Endpoint");
+
+  //Create parameter map
+  vector<HTTPHeader> reqParamMap;
+  reqParamMap.push_back(HTTPHeader("X-Auth-Token", _account->getTokenID()));
+  reqParamMap.push_back(HTTPHeader("Transfer-Encoding", "chunked"));
+  reqParamMap.push_back(HTTPHeader("Accept", "application/json"));
+
+  URI uri(swiftEndpoint->getPublicUrl());
+  //Error paths are given from the account on, e.g. /v1/AUTH_test/c/o
+  string accountPath = uri.getPath() + "/";
+  if (!_path.empty()) {
+    string encoded;
+    URI::encode(_path, "", encoded);
+    uri.setPath(uri.getPath() + "/" + encoded);
+  }
+  vector<HTTPHeader> uriParams;
+  uriParams.push_back(HTTPHeader("extract-archive", _gzip ? "tar.gz" : "tar"));
+  uri.setRawQuery(buildQuery(&uriParams));
+
+  SwiftResult<ArchiveUploadResult*> *result =
+      new SwiftResult<ArchiveUploadResult*>();
+  result->setPayload(nullptr);
+  HTTPResponse *httpResponse = new HTTPResponse();
+  result->setResponse(httpResponse);
+  //Stat cache entries of the written names, dropped once the server
+  //answered; a stat during the upload may still see the old objects
+  shared_ptr<StatCache> statCache = _account->getStatCache();
+  string statPrefix = _path.empty() ? "" : _path + "/";
+  vector<string> written;
+  auto invalidateWritten = [&statCache, &written]() {
+    if (statCache)
+      for (const string &path : written)
+        statCache->invalidate(path);
+    written.clear();
+  };
+  try {
+    ostream *requestStream = nullptr;
+    HTTPClientSession *httpSession = doHTTPIO(uri, HTTPRequest::HTTP_PUT,
+        &reqParamMap, requestStream);
+    result->setSession(httpSession);
+    _account->increaseCallCounter();
+
+    int64_t mtime = time(nullptr);
+    ArchiveEntry entry;
+    ostream *tarStream = requestStream;
+    unique_ptr<DeflatingOutputStream> gzipStream;
+    if (_gzip) {
+      gzipStream.reset(new DeflatingOutputStream(*requestStream,
+          DeflatingStreamBuf::STREAM_GZIP));
+      tarStream = gzipStream.get();
+    }
+    while (tarStream->good() && _source(entry)) {
+      writeEntry(*tarStream, entry, mtime);
+      if (statCache)
+        written.push_back(statPrefix + entry.name);
+    }
+    writeEnd(*tarStream);
+    if (gzipStream)
+      gzipStream->close();
+    requestStream->flush();
+
+    istream &responseStream = httpSession->receiveResponse(*httpResponse);
+    invalidateWritten();
+    if (httpResponse->getStatus() != HTTPResponse::HTTP_OK
+        && httpResponse->getStatus() != HTTPResponse::HTTP_CREATED) {
+      string errorText = "Code:";
+      errorText += to_string(httpResponse->getStatus()) + "\tReason:"
+          + httpResponse->getReason();
+      result->setError(SwiftError(SwiftError::SWIFT_HTTP_ERROR, errorText));
+      return result;
+    }
+
+    /**
+     * {"Number Files Created": 2, "Response Status": "201 Created",
+     * "Response Body": "", "Errors": [["/v1/AUTH_test/c/o", "400 ..."]]}
+     * Whitespace may precede it; it keeps long uploads alive.
+     */
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(responseStream, root, false) || !root.isObject()) {
+      result->setError(SwiftError(SwiftError::SWIFT_JSON_PARSE_ERROR,
+          "Invalid extract archive response: "
+              + reader.getFormattedErrorMessages()));
+      return result;
+    }
+    ArchiveUploadResult *uploadResult = new ArchiveUploadResult();
+    result->setPayload(uploadResult);
+    uploadResult->created = root["Number Files Created"].asUInt64();
+    const Json::Value &errors = root["Errors"];
+    for (Json::ArrayIndex i = 0; errors.isArray() && i < errors.size(); i++) {
+      string name;
+      URI::decode(errors[i][0].asString(), name);
+      if (name.compare(0, accountPath.size(), accountPath) == 0)
+        name.erase(0, accountPath.size());
+      uploadResult->errors.push_back(
+          make_pair(name, errors[i][1].asString()));
+    }
+    //The archive as a whole was refused, e.g. it could not be read
+    string status = root["Response Status"].asString();
+    if (!status.empty() && status[0] != '2')
+      result->setError(SwiftError(SwiftError::SWIFT_HTTP_ERROR,
+          status + "\t" + root["Response Body"].asString()));
+    else
+      result->setError(SWIFT_OK);
+  } catch (Exception &e) {
+    invalidateWritten();
+    result->setError(SwiftError(SwiftError::SWIFT_EXCEPTION, e.displayText()));
+  }
+  return result;
+}
+
+} /* namespace Swift */
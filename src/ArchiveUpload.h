@@ -0,0 +1,101 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef ARCHIVEUPLOAD_H_
+#define ARCHIVEUPLOAD_H_
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ErrorNo.h"
+#include "SwiftResult.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+class Account;
+
+/**
+ * One file of an archive upload. data must stay valid until the source is
+ * called again.
+ */
+struct SWIFTCPP_EXPORT ArchiveEntry {
+  std::string name;
+  const char *data = nullptr;
+  uint64_t size = 0;
+};
+
+/**
+ * Fills the next entry and returns true, or returns false at the end.
+ */
+typedef std::function<bool(ArchiveEntry&)> ArchiveEntrySource;
+
+/**
+ * Outcome of an archive upload
+ */
+struct SWIFTCPP_EXPORT ArchiveUploadResult {
+  uint64_t created = 0;
+  /**
+   * container/object path and status (e.g. "400 Bad Request") of every
+   * entry which was not stored
+   */
+  std::vector<std::pair<std::string, std::string> > errors;
+};
+
+/**
+ * Stores many small objects with one request through the bulk middleware
+ * (PUT ?extract-archive=tar): the entries are written as a tar stream,
+ * optionally gzipped, straight into a chunked request body.
+ */
+class SWIFTCPP_EXPORT ArchiveUpload {
+private:
+  ArchiveUpload() {}
+  ~ArchiveUpload() {}
+
+public:
+  /**
+   * Uploads the entries of _source below _path ("" for the account, where
+   * entry names start with their container, or a container name).
+   * @return
+   *  The payload is set whenever the server answered, also when the error
+   *  is not SWIFT_OK because the whole archive was refused.
+   */
+  static SwiftResult<ArchiveUploadResult*>* run(Account *_account,
+      const std::string &_path, const ArchiveEntrySource &_source,
+      bool _gzip);
+
+  /**
+   * Writes one tar entry: a ustar header (preceded by a pax header for
+   * names or sizes of 8GB and more which do not fit), the data and its
+   * padding.
+   */
+  static void writeEntry(std::ostream &_out, const ArchiveEntry &_entry,
+      int64_t _mtime);
+
+  /**
+   * Writes the two zero blocks which end a tar stream.
+   */
+  static void writeEnd(std::ostream &_out);
+};
+
+} /* namespace Swift */
+#endif /* ARCHIVEUPLOAD_H_ */
@@ -0,0 +1,81 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "BodySource.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+namespace Swift {
+
+MemoryBodySource::MemoryBodySource(const char *_buffer, uint64_t _length) :
+    buffer(_buffer), length(_length), position(0) {
+}
+
+uint64_t MemoryBodySource::read(char *_buffer, uint64_t _length) {
+  uint64_t count = min(_length, length - position);
+  memcpy(_buffer, buffer + position, count);
+  position += count;
+  return count;
+}
+
+uint64_t MemoryBodySource::size() const {
+  return length;
+}
+
+bool MemoryBodySource::rewind() {
+  position = 0;
+  return true;
+}
+
+const char* MemoryBodySource::data() const {
+  return buffer;
+}
+
+FileBodySource::FileBodySource(int _fd, uint64_t _offset, uint64_t _length) :
+    fd(_fd), offset(_offset), length(_length), position(0) {
+}
+
+uint64_t FileBodySource::read(char *_buffer, uint64_t _length) {
+  uint64_t count = min(_length, length - position);
+  while (count > 0) {
+    ssize_t n = pread(fd, _buffer, count, offset + position);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return 0;
+    position += n;
+    return n;
+  }
+  return 0;
+}
+
+uint64_t FileBodySource::size() const {
+  return length;
+}
+
+bool FileBodySource::rewind() {
+  position = 0;
+  return true;
+}
+
+} /* namespace Swift */
@@ -0,0 +1,102 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef BODYSOURCE_H_
+#define BODYSOURCE_H_
+
+#include <cstdint>
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Request body of known length which is pulled in chunks while the request
+ * is sent. The whole body never has to be in memory at once, and it can be
+ * sent again (e.g. after re-authentication) by rewinding it.
+ */
+class SWIFTCPP_EXPORT BodySource {
+public:
+  virtual ~BodySource() {}
+
+  /**
+   * Copies up to _length next bytes of the body into _buffer.
+   * @return
+   *  Number of bytes copied, 0 at the end of the body or on failure.
+   */
+  virtual uint64_t read(char *_buffer, uint64_t _length) = 0;
+
+  /**
+   * Total length of the body, sent as Content-Length
+   */
+  virtual uint64_t size() const = 0;
+
+  /**
+   * Goes back to the first byte of the body.
+   * @return
+   *  false if this source cannot be read again.
+   */
+  virtual bool rewind() = 0;
+
+  /**
+   * Contiguous sources return their whole content here so it can be sent
+   * without copying; others return nullptr and are read().
+   */
+  virtual const char* data() const {
+    return nullptr;
+  }
+};
+
+/**
+ * Body backed by a caller owned buffer which must outlive the request.
+ */
+class SWIFTCPP_EXPORT MemoryBodySource: public BodySource {
+  const char *buffer;
+  uint64_t length;
+  uint64_t position;
+
+public:
+  MemoryBodySource(const char *_buffer, uint64_t _length);
+
+  uint64_t read(char *_buffer, uint64_t _length);
+  uint64_t size() const;
+  bool rewind();
+  const char* data() const;
+};
+
+/**
+ * Body made of _length bytes of an open file starting at _offset. Reads
+ * use pread(), so the descriptor offset is untouched and one descriptor
+ * may back several sources; it is not closed by this class.
+ */
+class SWIFTCPP_EXPORT FileBodySource: public BodySource {
+  int fd;
+  uint64_t offset;
+  uint64_t length;
+  uint64_t position;
+
+public:
+  FileBodySource(int _fd, uint64_t _offset, uint64_t _length);
+
+  uint64_t read(char *_buffer, uint64_t _length);
+  uint64_t size() const;
+  bool rewind();
+};
+
+} /* namespace Swift */
+#endif /* BODYSOURCE_H_ */
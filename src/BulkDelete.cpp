@@ -0,0 +1,213 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "BulkDelete.h"
+#include "Executor.h"
+#include "HTTPIO.h"
+#include "json.h"
+#include <Poco/URI.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * One encoded "/container/object" line per name, produced on demand so a
+ * batch of 10000 long names is never held in memory as a whole.
+ */
+class PathListBodySource: public BodySource {
+  const string &prefix;
+  const vector<string> &paths;
+  size_t begin;
+  size_t end;
+  uint64_t length;
+
+  /**
+   * Next name to encode and the unsent part of the current line
+   */
+  size_t next;
+  string line;
+  size_t lineOffset;
+
+  void encodeLine(size_t _index, string &_line) const {
+    _line = "/";
+    URI::encode(prefix + paths[_index], "?#", _line);
+    _line += "\n";
+  }
+
+public:
+  PathListBodySource(const string &_prefix, const vector<string> &_paths,
+      size_t _begin, size_t _end) :
+      prefix(_prefix), paths(_paths), begin(_begin), end(_end), length(0),
+      next(_begin), lineOffset(0) {
+    string encoded;
+    for (size_t i = begin; i < end; i++) {
+      encodeLine(i, encoded);
+      length += encoded.size();
+    }
+  }
+
+  uint64_t read(char *_buffer, uint64_t _length) {
+    uint64_t copied = 0;
+    while (copied < _length) {
+      if (lineOffset == line.size()) {
+        if (next == end)
+          break;
+        encodeLine(next++, line);
+        lineOffset = 0;
+      }
+      size_t chunk = min<uint64_t>(line.size() - lineOffset,
+          _length - copied);
+      memcpy(_buffer + copied, line.data() + lineOffset, chunk);
+      lineOffset += chunk;
+      copied += chunk;
+    }
+    return copied;
+  }
+
+  uint64_t size() const {
+    return length;
+  }
+
+  bool rewind() {
+    next = begin;
+    line.clear();
+    lineOffset = 0;
+    return true;
+  }
+};
+
+SwiftResult<BulkDeleteResult*>* BulkDelete::run(Account *_account,
+    const string &_prefix, const vector<string> &_paths,
+    uint32_t _parallelism) {
+  if (_account == nullptr)
+    return returnNullError<BulkDeleteResult*>("account");
+  SwiftResult<BulkDeleteResult*> *result =
+      new SwiftResult<BulkDeleteResult*>();
+  result->setResponse(nullptr);
+  result->setSession(nullptr);
+  BulkDeleteResult *deleteResult = new BulkDeleteResult();
+  result->setPayload(deleteResult);
+  result->setError(SWIFT_OK);
+  if (_paths.empty())
+    return result;
+
+  size_t batchSize = _account->getMaxDeletesPerRequest();
+  size_t numBatches = (_paths.size() + batchSize - 1) / batchSize;
+  atomic<size_t> nextBatch(0);
+  mutex resultMutex;
+  runOnThreads(min<size_t>(max<uint32_t>(_parallelism, 1), numBatches),
+      [&]() {
+        for (size_t i = nextBatch++; i < numBatches; i = nextBatch++) {
+          size_t begin = i * batchSize;
+          size_t end = min(begin + batchSize, _paths.size());
+          BulkDeleteResult batchResult;
+          SwiftError error = deleteBatch(_account, _prefix, _paths, begin,
+              end, batchResult);
+
+          lock_guard<mutex> guard(resultMutex);
+          deleteResult->deleted += batchResult.deleted;
+          deleteResult->notFound += batchResult.notFound;
+          deleteResult->errors.insert(deleteResult->errors.end(),
+              batchResult.errors.begin(), batchResult.errors.end());
+          if (error.code != SWIFT_OK.code)
+            result->setError(error);
+        }
+      });
+  return result;
+}
+
+SwiftError BulkDelete::deleteBatch(Account *_account, const string &_prefix,
+    const vector<string> &_paths, size_t _begin, size_t _end,
+    BulkDeleteResult &_result) {
+  /**
+   * 200:
+   *  The batch was processed; the body holds the per name outcome.
+   *  Problems with single names do not change the status.
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+
+  vector<HTTPHeader> uriParams;
+  uriParams.push_back(HTTPHeader("bulk-delete", ""));
+  vector<HTTPHeader> reqMap;
+  reqMap.push_back(HTTPHeader("Accept", "application/json"));
+
+  PathListBodySource body(_prefix, _paths, _begin, _end);
+  string contentType = "text/plain";
+  string path = "";
+  SwiftResult<istream*> *response = doSwiftTransaction<istream*>(_account,
+      path, HTTPRequest::HTTP_POST, &uriParams, &reqMap, &validHTTPCodes,
+      body, &contentType);
+
+  SwiftError error = response->getError();
+  if (error.code == SWIFT_OK.code)
+    error = parseResponse(*response->getPayload(), _result);
+  delete response;
+
+  shared_ptr<StatCache> statCache = _account->getStatCache();
+  if (statCache)
+    for (size_t i = _begin; i < _end; i++)
+      statCache->invalidate(_prefix + _paths[i]);
+
+  if (error.code != SWIFT_OK.code && _result.deleted == 0
+      && _result.notFound == 0 && _result.errors.empty())
+    for (size_t i = _begin; i < _end; i++)
+      _result.errors.push_back(make_pair(_prefix + _paths[i], error.msg));
+  return error;
+}
+
+SwiftError BulkDelete::parseResponse(istream &_response,
+    BulkDeleteResult &_result) {
+  /**
+   * {"Number Deleted": 2, "Number Not Found": 0, "Response Status":
+   * "200 OK", "Response Body": "", "Errors": [["/c/o", "409 Conflict"]]}
+   * Whitespace may precede it; it keeps long batches alive.
+   */
+  Json::Value root;
+  Json::Reader reader;
+  if (!reader.parse(_response, root, false) || !root.isObject())
+    return SwiftError(SwiftError::SWIFT_JSON_PARSE_ERROR,
+        "Invalid bulk delete response: " + reader.getFormattedErrorMessages());
+
+  _result.deleted += root["Number Deleted"].asUInt64();
+  _result.notFound += root["Number Not Found"].asUInt64();
+  const Json::Value &errors = root["Errors"];
+  for (Json::ArrayIndex i = 0; errors.isArray() && i < errors.size(); i++) {
+    string name;
+    URI::decode(errors[i][0].asString(), name);
+    if (!name.empty() && name[0] == '/')
+      name.erase(0, 1);
+    _result.errors.push_back(make_pair(name, errors[i][1].asString()));
+  }
+  //The whole batch was refused, e.g. too many names
+  string status = root["Response Status"].asString();
+  if (errors.size() == 0 && !status.empty() && status[0] != '2')
+    return SwiftError(SwiftError::SWIFT_HTTP_ERROR,
+        status + "\t" + root["Response Body"].asString());
+  return SWIFT_OK;
+}
+
+} /* namespace Swift */
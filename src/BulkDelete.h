@@ -0,0 +1,87 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef BULKDELETE_H_
+#define BULKDELETE_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Account.h"
+#include "ErrorNo.h"
+#include "SwiftResult.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Outcome of a bulk delete
+ */
+struct SWIFTCPP_EXPORT BulkDeleteResult {
+  uint64_t deleted = 0;
+  uint64_t notFound = 0;
+  /**
+   * container/object path and status (e.g. "409 Conflict") of every name
+   * which was not deleted
+   */
+  std::vector<std::pair<std::string, std::string> > errors;
+};
+
+/**
+ * Deletes many names through the bulk middleware (POST ?bulk-delete): up
+ * to max_deletes_per_request names go in one request, whose newline
+ * separated body is generated while it is sent.
+ */
+class SWIFTCPP_EXPORT BulkDelete {
+private:
+  BulkDelete() {}
+  ~BulkDelete() {}
+
+public:
+  /**
+   * Deletes _prefix + _paths[i] for every i, in batches which run on
+   * _parallelism connections at once.
+   * @return
+   *  The combined result of all batches, also when some failed; the error
+   *  is that of the last failed batch, whose names are listed in errors.
+   */
+  static SwiftResult<BulkDeleteResult*>* run(Account *_account,
+      const std::string &_prefix, const std::vector<std::string> &_paths,
+      uint32_t _parallelism);
+
+  /**
+   * Deletes _prefix + _paths[i] for i in [_begin, _end) with one request
+   * and adds the per name results to _result.
+   */
+  static SwiftError deleteBatch(Account *_account, const std::string &_prefix,
+      const std::vector<std::string> &_paths, size_t _begin, size_t _end,
+      BulkDeleteResult &_result);
+
+  /**
+   * Adds the JSON outcome of a bulk delete, or of a multipart-manifest
+   * delete which has the same format, to _result.
+   */
+  static SwiftError parseResponse(std::istream &_response,
+      BulkDeleteResult &_result);
+};
+
+} /* namespace Swift */
+#endif /* BULKDELETE_H_ */
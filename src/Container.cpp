@@ -19,8 +19,16 @@
 
 #include "Container.h"
 #include <sstream>      // ostringstream
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "BulkDelete.h"
 #include "HTTPIO.h"
 #include "Object.h"
+#include "ObjectIterator.h"
+#include "ObjectListing.h"
+#include "ListingCache.h"
+#include "Executor.h"
 
 using namespace std;
 using namespace Poco;
@@ -40,6 +48,22 @@ Container::~Container() {
 SwiftResult<std::istream*>* Container::swiftListObjects(
     HTTPHeader& _formatHeader, std::vector<HTTPHeader>* _uriParam,
     bool _newest) {
+  //Push Header Format, leaving the caller's parameters untouched
+  vector<HTTPHeader> uriParams;
+  if (_uriParam != nullptr)
+    uriParams = *_uriParam;
+  uriParams.push_back(_formatHeader);
+  return listObjects(uriParams, _newest);
+}
+
+SwiftResult<std::istream*>* Container::swiftListObjects(
+    const ListingQuery &_query, bool _newest) {
+  vector<HTTPHeader> uriParams = _query.toParams();
+  return listObjects(uriParams, _newest);
+}
+
+SwiftResult<std::istream*>* Container::listObjects(
+    std::vector<HTTPHeader> &_uriParams, bool _newest) {
   //Check Container
   if (account == nullptr)
     return returnNullError<istream*>("account");
@@ -67,24 +91,41 @@ SwiftResult<std::istream*>* Container::swiftListObjects(
     HTTPHeader header("X-Newest", "True");
     _reqMap.push_back(header);
   }
-  //Push Header Format
-  bool shouldDelete = false;
-  if (_uriParam == nullptr) {
-    _uriParam = new vector<HTTPHeader>();
-    shouldDelete = true;
-  }
-  _uriParam->push_back(_formatHeader);
 
   //Do swift transaction
-  SwiftResult<istream*> *result = doSwiftTransaction<istream*>(this->account, path,
-      HTTPRequest::HTTP_GET, _uriParam, &_reqMap, &validHTTPCodes, nullptr, 0,
+  return doSwiftTransaction<istream*>(this->account, path,
+      HTTPRequest::HTTP_GET, &_uriParams, &_reqMap, &validHTTPCodes, nullptr, 0,
       nullptr);
-  if(!shouldDelete)
-    return result;
-  else {
-    delete _uriParam;
-    return result;
-  }
+}
+
+SwiftResult<BulkDeleteResult*>* Container::swiftBulkDelete(
+    const std::vector<std::string> &_names, uint32_t _parallelism) {
+  return BulkDelete::run(account, name + "/", _names, _parallelism);
+}
+
+SwiftResult<BulkDeleteResult*>* Container::swiftPurge(
+    const PurgeOptions &_options) {
+  return ContainerPurge::run(this, _options);
+}
+
+SwiftResult<ArchiveUploadResult*>* Container::swiftUploadArchive(
+    const ArchiveEntrySource &_source, bool _gzip) {
+  return ArchiveUpload::run(account, name, _source, _gzip);
+}
+
+SwiftResult<ArchiveUploadResult*>* Container::swiftUploadArchive(
+    const std::vector<std::pair<std::string, std::string> > &_entries,
+    bool _gzip) {
+  size_t next = 0;
+  return swiftUploadArchive([&](ArchiveEntry &_entry) {
+    if (next == _entries.size())
+      return false;
+    _entry.name = _entries[next].first;
+    _entry.data = _entries[next].second.data();
+    _entry.size = _entries[next].second.size();
+    next++;
+    return true;
+  }, _gzip);
 }
 
 SwiftResult<int*>* Container::swiftCreateContainer(
@@ -227,49 +268,240 @@ std::string& Container::getName() {
 }
 
 SwiftResult<vector<Object>*>* Container::swiftGetObjects(bool _newest) {
-  SwiftResult<istream*> *objectList = this->swiftListObjects(HEADER_FORMAT_APPLICATION_JSON,nullptr,_newest);
   SwiftResult<vector<Object>*> *result = new SwiftResult<vector<Object>*>();
-  result->setError(objectList->getError());
   result->setResponse(nullptr);
   result->setSession(nullptr);
 
+  //A single listing stops at 10000 names: page through all of them
+  vector<Object>*objects = new vector<Object>();
+  ObjectIterator iterator(this, 10000, "", "", _newest);
+  while (iterator.hasNext())
+    objects->push_back(iterator.next());
+
   //Check error
-  if(objectList->getError().code != SWIFT_OK.code) {
+  result->setError(iterator.getError());
+  if (iterator.getError().code != SWIFT_OK.code) {
+    delete objects;
     result->setPayload(nullptr);
-    delete objectList;
     return result;
   }
 
-  //Parse JSON
-  Json::Value root;   // will contains the root value after parsing.
-  Json::Reader reader;
-  bool parsingSuccessful = reader.parse(*objectList->getPayload(), root, false);
-  if (!parsingSuccessful) {
-    SwiftError error(SwiftError::SWIFT_JSON_PARSE_ERROR,
-        reader.getFormattedErrorMessages());
-    result->setError(error);
+  //Set payload
+  result->setPayload(objects);
+  return result;
+}
+
+/**
+ * Appends every object of _container between _marker and _endMarker
+ * (both exclusive, empty for no limit) to _listing, page after page.
+ */
+static SwiftError listRange(Container *_container, const string &_prefix,
+    const string &_marker, const string &_endMarker, bool _newest,
+    ObjectListing &_listing) {
+  const uint32_t pageSize = 10000;
+  string marker = _marker;
+  uint32_t entries = pageSize;
+  SwiftError error = SWIFT_OK;
+  while (entries == pageSize && error.code == SWIFT_OK.code) {
+    error = ObjectIterator::fetchEntries(_container, pageSize, _prefix,
+        marker, _endMarker, _newest, [&](const ListingEntry &_entry) {
+          _listing.add(_entry);
+          marker = _entry.subdir.empty() ? _entry.name : _entry.subdir;
+          return true;
+        }, entries);
+  }
+  return error;
+}
+
+SwiftResult<ObjectListing*>* Container::swiftGetObjectListing(
+    const std::string &_prefix, bool _newest) {
+  SwiftResult<ObjectListing*> *result = new SwiftResult<ObjectListing*>();
+  result->setResponse(nullptr);
+  result->setSession(nullptr);
+
+  if (_prefix.empty() && ListingCache::isEnabled()) {
+    delete result;
+    return ListingCache::getListing(*this, _newest);
+  }
+
+  //Entries go straight from the parser into the arena
+  ObjectListing *listing = new ObjectListing(this);
+  SwiftError error = listRange(this, _prefix, "", "", _newest, *listing);
+
+  result->setError(error);
+  if (error.code != SWIFT_OK.code) {
+    delete listing;
     result->setPayload(nullptr);
-    delete objectList;
     return result;
   }
+  listing->shrinkToFit();
+  result->setPayload(listing);
+  return result;
+}
 
-  //Allocate containers
-  vector<Object>*objects = new vector<Object>();
-  //Successful parse
-  for(unsigned int i=0;i<root.size();i++) {
-    string name = root[i].get("name","").asString();
-    size_t length = root[i].get("bytes", -1).asInt64();
-    string content_type = root[i].get("content_type","").asString();
-    string hash = root[i].get("hash","").asString();
-    string last_modified = root[i].get("last_modified","").asString();
-    //Create new object
-    Object object(this,name,length,content_type,hash,last_modified);
-    objects->push_back(object);
+/**
+ * Highest Unicode code point; no name continues past prefix + this
+ */
+static const string MAX_CHARACTER = "\xf4\x8f\xbf\xbf";
+
+/**
+ * Length of the UTF-8 sequence starting with _lead
+ */
+static size_t utf8Length(unsigned char _lead) {
+  if (_lead >= 0xF0)
+    return 4;
+  if (_lead >= 0xE0)
+    return 3;
+  if (_lead >= 0xC0)
+    return 2;
+  return 1;
+}
+
+/**
+ * Finds the distinct one character extensions of _prefix among the names,
+ * one limit=1 request per extension found.
+ */
+static SwiftError probeChildren(Container *_container, const string &_prefix,
+    bool _newest, vector<string> &_children) {
+  string marker = _prefix;
+  while (true) {
+    string first;
+    uint32_t entries = 0;
+    SwiftError error = ObjectIterator::fetchEntries(_container, 1, _prefix,
+        marker, "", _newest, [&](const ListingEntry &_entry) {
+          first = _entry.subdir.empty() ? _entry.name : _entry.subdir;
+          return true;
+        }, entries);
+    if (error.code != SWIFT_OK.code)
+      return error;
+    if (entries == 0 || first.size() <= _prefix.size())
+      return SWIFT_OK;
+    string child = first.substr(0,
+        _prefix.size() + utf8Length(first[_prefix.size()]));
+    _children.push_back(child);
+    //Skip every name which starts with child
+    marker = child + MAX_CHARACTER;
   }
+}
 
-  //Set payload
-  result->setPayload(objects);
-  delete objectList;
+SwiftResult<std::vector<std::string>*>* Container::swiftFindListingBoundaries(
+    uint32_t _partitions, uint32_t _parallelism, bool _newest) {
+  SwiftResult<vector<string>*> *result = new SwiftResult<vector<string>*>();
+  result->setResponse(nullptr);
+  result->setSession(nullptr);
+  result->setPayload(nullptr);
+
+  //Prefixes one character longer per round, until there are enough
+  vector<string> prefixes(1, "");
+  const uint32_t maxDepth = 8;
+  for (uint32_t depth = 0; depth < maxDepth && prefixes.size() < _partitions;
+      depth++) {
+    vector<vector<string> > children(prefixes.size());
+    atomic<size_t> next(0);
+    mutex errorMutex;
+    SwiftError error = SWIFT_OK;
+    runOnThreads(min<size_t>(max<uint32_t>(_parallelism, 1), prefixes.size()),
+        [&]() {
+          for (size_t i = next++; i < prefixes.size(); i = next++) {
+            SwiftError probeError = probeChildren(this, prefixes[i], _newest,
+                children[i]);
+            if (probeError.code != SWIFT_OK.code) {
+              lock_guard<mutex> guard(errorMutex);
+              error = probeError;
+            }
+          }
+        });
+    if (error.code != SWIFT_OK.code) {
+      result->setError(error);
+      return result;
+    }
+    vector<string> expanded;
+    for (vector<string> &group : children)
+      expanded.insert(expanded.end(), group.begin(), group.end());
+    //Names ending here drop out; that only merges two partitions
+    if (expanded.empty())
+      break;
+    prefixes.swap(expanded);
+  }
+
+  //The first partition starts at the beginning anyway
+  vector<string> *boundaries = new vector<string>();
+  for (size_t i = 1; i < prefixes.size(); i++)
+    boundaries->push_back(prefixes[i]);
+  result->setError(SWIFT_OK);
+  result->setPayload(boundaries);
+  return result;
+}
+
+SwiftResult<ObjectListing*>* Container::swiftGetObjectListingParallel(
+    uint32_t _parallelism, const std::vector<std::string> *_boundaries,
+    bool _newest) {
+  SwiftResult<ObjectListing*> *result = new SwiftResult<ObjectListing*>();
+  result->setResponse(nullptr);
+  result->setSession(nullptr);
+  result->setPayload(nullptr);
+  uint32_t parallelism = max<uint32_t>(_parallelism, 1);
+
+  vector<string> boundaries;
+  if (_boundaries != nullptr)
+    boundaries = *_boundaries;
+  else {
+    //A few partitions per connection evens out their different sizes
+    SwiftResult<vector<string>*> *found = swiftFindListingBoundaries(
+        parallelism * 4, parallelism, _newest);
+    if (found->getError().code != SWIFT_OK.code) {
+      result->setError(found->getError());
+      delete found;
+      return result;
+    }
+    boundaries = *found->getPayload();
+    delete found;
+  }
+  sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(unique(boundaries.begin(), boundaries.end()),
+      boundaries.end());
+  boundaries.erase(remove(boundaries.begin(), boundaries.end(), ""),
+      boundaries.end());
+
+  /**
+   * Partition i holds the names in (boundary i-1, boundary i]. Markers
+   * are exclusive, so the end marker is the boundary followed by \x01:
+   * only the boundary itself sorts between the two, as names cannot
+   * contain \x00.
+   */
+  size_t numPartitions = boundaries.size() + 1;
+  vector<ObjectListing> partitions(numPartitions, ObjectListing(this));
+  atomic<size_t> next(0);
+  atomic<bool> failed(false);
+  mutex errorMutex;
+  SwiftError error = SWIFT_OK;
+  runOnThreads(min<size_t>(parallelism, numPartitions), [&]() {
+    for (size_t i = next++; i < numPartitions && !failed; i = next++) {
+      string marker = i == 0 ? "" : boundaries[i - 1];
+      string endMarker = i == numPartitions - 1 ? "" : boundaries[i] + "\x01";
+      SwiftError rangeError = listRange(this, "", marker, endMarker, _newest,
+          partitions[i]);
+      if (rangeError.code != SWIFT_OK.code) {
+        lock_guard<mutex> guard(errorMutex);
+        error = rangeError;
+        failed = true;
+      }
+    }
+  });
+  if (failed) {
+    result->setError(error);
+    return result;
+  }
+
+  //Partitions are in name order: concatenating them merges the listing
+  ObjectListing *listing = new ObjectListing(this);
+  for (ObjectListing &partition : partitions) {
+    listing->append(partition);
+    partition = ObjectListing(this);
+  }
+  listing->shrinkToFit();
+  result->setError(SWIFT_OK);
+  result->setPayload(listing);
   return result;
 }
 
@@ -307,6 +539,31 @@ SwiftResult<int*>* Container::swiftShowMetadata(bool _newest) {
 }
 
 
+future<SwiftResult<vector<Object>*>*> Container::swiftGetObjectsAsync(
+    bool _newest) {
+  //The returned Objects point at this Container, not at a copy
+  return Executor::getDefault().submit([this, _newest]() {
+    return this->swiftGetObjects(_newest);
+  });
+}
+
+future<SwiftResult<istream*>*> Container::swiftListObjectsAsync(
+    HTTPHeader& _formatHeader, std::vector<HTTPHeader>* _uriParam,
+    bool _newest) {
+  HTTPHeader formatHeader(_formatHeader);
+  shared_ptr<vector<HTTPHeader> > uriParam = copyHeaders(_uriParam);
+  return Executor::getDefault().submit(
+      [this, formatHeader, uriParam, _newest]() mutable {
+        return this->swiftListObjects(formatHeader, uriParam.get(), _newest);
+      });
+}
+
+future<SwiftResult<int*>*> Container::swiftShowMetadataAsync(bool _newest) {
+  return Executor::getDefault().submit([this, _newest]() {
+    return this->swiftShowMetadata(_newest);
+  });
+}
+
 uint64_t Container::getBytesUsed() const{
   return bytes;
 }
@@ -21,11 +21,16 @@
 #define CONTAINER_H_
 
 #include "Account.h"
+#include "ContainerPurge.h"
+#include "ListingQuery.h"
 #include "swiftcpp_export.h"
 
+#include <future>
+
 namespace Swift {
 
 class Object;
+class ObjectListing;
 
 class SWIFTCPP_EXPORT Container
 {
@@ -34,6 +39,11 @@ class SWIFTCPP_EXPORT Container
   uint64_t bytes;
   uint64_t totalObjects;
 
+  /**
+   * GET on this container with the given query parameters
+   */
+  SwiftResult<std::istream*>* listObjects(std::vector<HTTPHeader> &_uriParams,
+      bool _newest);
 
 public:
   Container(Account *_account, std::string _name = "");
@@ -43,10 +53,44 @@ public:
   /**
    * Lists the objects under this container
    * @return
-   *  A vector of Objects under this container
+   *  A vector of all Objects under this container, fetched 10000 at a
+   *  time. Use ObjectIterator to go through big containers without
+   *  holding every Object in memory.
    */
   SwiftResult<std::vector<Object>*>* swiftGetObjects(bool _newest = false);
 
+  /**
+   * Same as swiftGetObjects in a compact form meant for big containers;
+   * see ObjectListing. Unprefixed listings go through ListingCache when
+   * it is enabled.
+   * _prefix
+   *  Only list names starting with this prefix.
+   */
+  SwiftResult<ObjectListing*>* swiftGetObjectListing(
+      const std::string &_prefix = "", bool _newest = false);
+
+  /**
+   * Same as swiftGetObjectListing but the name space is cut into ranges
+   * which are listed on _parallelism connections at once, then merged in
+   * name order.
+   * _boundaries
+   *  Names where the ranges are cut (each one ends a range), e.g. known
+   *  prefixes; found with swiftFindListingBoundaries when nullptr.
+   */
+  SwiftResult<ObjectListing*>* swiftGetObjectListingParallel(
+      uint32_t _parallelism = 8,
+      const std::vector<std::string> *_boundaries = nullptr,
+      bool _newest = false);
+
+  /**
+   * Samples the names of this container for about _partitions sorted
+   * boundaries for swiftGetObjectListingParallel. Distinct leading
+   * characters are found with limit=1 requests, one level deeper until
+   * there are enough of them.
+   */
+  SwiftResult<std::vector<std::string>*>* swiftFindListingBoundaries(
+      uint32_t _partitions, uint32_t _parallelism = 8, bool _newest = false);
+
   /**
    * Similar to swiftGetObjects; however, only returns the name
    * of existing objects in this account.
@@ -57,6 +101,13 @@ public:
   SwiftResult<std::istream*>* swiftListObjects(HTTPHeader &_formatHeader = HEADER_FORMAT_APPLICATION_JSON,
       std::vector<HTTPHeader> *_uriParam = nullptr, bool _newest = false);
 
+  /**
+   * Same as above with the prefix, delimiter, marker, limit, ... filters
+   * of _query applied by the server.
+   */
+  SwiftResult<std::istream*>* swiftListObjects(const ListingQuery &_query,
+      bool _newest = false);
+
   /**
    * Creates this container on the Swift server
    * @return
@@ -71,6 +122,38 @@ public:
    */
   SwiftResult<int*>* swiftDeleteContainer();
 
+  /**
+   * Deletes every object of this container, then the container itself.
+   * The listing is streamed and the objects deleted while it is read; see
+   * ContainerPurge and PurgeOptions.
+   */
+  SwiftResult<BulkDeleteResult*>* swiftPurge(
+      const PurgeOptions &_options = PurgeOptions());
+
+  /**
+   * Deletes the objects _names of this container through the bulk
+   * middleware, max_deletes_per_request names per request and
+   * _parallelism requests at once. See Account::swiftBulkDelete.
+   */
+  SwiftResult<BulkDeleteResult*>* swiftBulkDelete(
+      const std::vector<std::string> &_names, uint32_t _parallelism = 4);
+
+  /**
+   * Stores the entries of _source as objects of this container with a
+   * single extract-archive request. See ArchiveUpload.
+   * _gzip
+   *  Compress the tar stream; worth it for compressible data.
+   */
+  SwiftResult<ArchiveUploadResult*>* swiftUploadArchive(
+      const ArchiveEntrySource &_source, bool _gzip = false);
+
+  /**
+   * Same as above for (object name, content) pairs
+   */
+  SwiftResult<ArchiveUploadResult*>* swiftUploadArchive(
+      const std::vector<std::pair<std::string, std::string> > &_entries,
+      bool _gzip = false);
+
   /**
    * Adds metadata to this Container
    * @return
@@ -112,6 +195,25 @@ public:
    */
   SwiftResult<int*>* swiftShowMetadata(bool _newest = false);
 
+  /** Asynchronous API Functions **/
+
+  /**
+   * The ...Async functions run their blocking counterpart on
+   * Executor::getDefault() and return at once. Request parameters are
+   * copied; this Container and its Account must stay valid until the
+   * future is ready, and as long as the Objects returned by
+   * swiftGetObjectsAsync are used. The caller owns the SwiftResult
+   * returned by the future.
+   */
+  std::future<SwiftResult<std::vector<Object>*>*> swiftGetObjectsAsync(
+      bool _newest = false);
+
+  std::future<SwiftResult<std::istream*>*> swiftListObjectsAsync(
+      HTTPHeader &_formatHeader = HEADER_FORMAT_APPLICATION_JSON,
+      std::vector<HTTPHeader> *_uriParam = nullptr, bool _newest = false);
+
+  std::future<SwiftResult<int*>*> swiftShowMetadataAsync(bool _newest = false);
+
   Account* getAccount();
   std::string& getName();
   void setName(const std::string& name);
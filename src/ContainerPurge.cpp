@@ -0,0 +1,277 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ContainerPurge.h"
+#include "Container.h"
+#include "Executor.h"
+#include "HTTPIO.h"
+#include "ObjectIterator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * Names deleted together: one bulk delete request, or a run of single
+ * DELETEs on one connection.
+ */
+struct PurgeBatch {
+  vector<string> names;
+  uint64_t bytes = 0;
+  bool manifests = false;
+};
+
+/**
+ * Hands batches from the listing to the delete threads; the listing waits
+ * while the queue is full so it never runs far ahead.
+ */
+class PurgeQueue {
+  deque<PurgeBatch> batches;
+  size_t capacity;
+  bool closed;
+  mutex queueMutex;
+  condition_variable changed;
+
+public:
+  PurgeQueue(size_t _capacity) :
+      capacity(_capacity), closed(false) {
+  }
+
+  void push(PurgeBatch &_batch) {
+    unique_lock<mutex> lock(queueMutex);
+    while (batches.size() >= capacity)
+      changed.wait(lock);
+    batches.push_back(PurgeBatch());
+    batches.back().names.swap(_batch.names);
+    batches.back().bytes = _batch.bytes;
+    batches.back().manifests = _batch.manifests;
+    _batch.bytes = 0;
+    changed.notify_all();
+  }
+
+  /**
+   * @return false once the queue is closed and empty
+   */
+  bool pop(PurgeBatch &_batch) {
+    unique_lock<mutex> lock(queueMutex);
+    while (batches.empty() && !closed)
+      changed.wait(lock);
+    if (batches.empty())
+      return false;
+    _batch = move(batches.front());
+    batches.pop_front();
+    changed.notify_all();
+    return true;
+  }
+
+  void close() {
+    lock_guard<mutex> guard(queueMutex);
+    closed = true;
+    changed.notify_all();
+  }
+};
+
+/**
+ * One DELETE; SLO manifests are deleted with their segments and answer
+ * like a bulk delete.
+ */
+static SwiftError deleteOne(Container *_container, const string &_name,
+    bool _manifest, BulkDeleteResult &_result) {
+  /**
+   * 200: manifest and segments processed, outcome in the body
+   * 204: deleted
+   * 404: already gone
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_NO_CONTENT);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_NOT_FOUND);
+
+  vector<HTTPHeader> uriParams;
+  vector<HTTPHeader> reqMap;
+  if (_manifest) {
+    uriParams.push_back(HTTPHeader("multipart-manifest", "delete"));
+    reqMap.push_back(HTTPHeader("Accept", "application/json"));
+  }
+  string path = _container->getName() + "/" + _name;
+  SwiftResult<istream*> *response = doSwiftTransaction<istream*>(
+      _container->getAccount(), path, HTTPRequest::HTTP_DELETE, &uriParams,
+      &reqMap, &validHTTPCodes);
+
+  SwiftError error = response->getError();
+  if (error.code == SWIFT_OK.code) {
+    int status = response->getResponse()->getStatus();
+    if (status == HTTPResponse::HTTP_NOT_FOUND)
+      _result.notFound++;
+    else if (status == HTTPResponse::HTTP_OK && _manifest)
+      error = BulkDelete::parseResponse(*response->getPayload(), _result);
+    else
+      _result.deleted++;
+  }
+  if (error.code != SWIFT_OK.code)
+    _result.errors.push_back(make_pair(path, error.msg));
+  delete response;
+  return error;
+}
+
+SwiftResult<BulkDeleteResult*>* ContainerPurge::run(Container *_container,
+    const PurgeOptions &_options) {
+  if (_container == nullptr || _container->getAccount() == nullptr)
+    return returnNullError<BulkDeleteResult*>("account");
+  Account *account = _container->getAccount();
+  SwiftResult<BulkDeleteResult*> *result =
+      new SwiftResult<BulkDeleteResult*>();
+  result->setResponse(nullptr);
+  result->setSession(nullptr);
+  BulkDeleteResult *total = new BulkDeleteResult();
+  result->setPayload(total);
+
+  bool bulk = account->isBulkDeleteSupported();
+  //Single DELETEs are batched only to spread them over the threads
+  size_t batchSize = bulk ? account->getMaxDeletesPerRequest() : 100;
+  uint32_t parallelism = max<uint32_t>(_options.parallelism, 1);
+  string prefix = _container->getName() + "/";
+
+  typedef chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  Clock::time_point lastReport = start;
+  PurgeProgress progress;
+  uint64_t reportedObjects = 0, reportedBytes = 0;
+  SwiftError error = SWIFT_OK;
+  mutex progressMutex;
+
+  PurgeQueue queue(parallelism * 2);
+  future<SwiftError> listing = async(launch::async, [&]() {
+    PurgeBatch objects, manifests;
+    manifests.manifests = true;
+    string marker;
+    uint32_t entries = 0;
+    SwiftError listError = SWIFT_OK;
+    do {
+      listError = ObjectIterator::fetchEntries(_container, 10000, "", marker,
+          "", false, [&](const ListingEntry &_entry) {
+            if (_entry.name.empty())
+              return true;
+            marker = _entry.name;
+            PurgeBatch &batch = _options.deleteSegments
+                && !_entry.sloEtag.empty() ? manifests : objects;
+            batch.names.push_back(_entry.name);
+            batch.bytes += _entry.bytes;
+            //A manifest delete is a bulk delete of its segments already
+            if (batch.names.size() >= (batch.manifests ? parallelism : batchSize))
+              queue.push(batch);
+            return true;
+          }, entries);
+      lock_guard<mutex> guard(progressMutex);
+      progress.objectsListed += entries;
+    } while (listError.code == SWIFT_OK.code && entries > 0);
+    if (!objects.names.empty())
+      queue.push(objects);
+    if (!manifests.names.empty())
+      queue.push(manifests);
+    queue.close();
+    return listError;
+  });
+
+  runOnThreads(parallelism, [&]() {
+    PurgeBatch batch;
+    while (queue.pop(batch)) {
+      BulkDeleteResult batchResult;
+      SwiftError batchError = SWIFT_OK;
+      if (bulk && !batch.manifests)
+        batchError = BulkDelete::deleteBatch(account, prefix, batch.names, 0,
+            batch.names.size(), batchResult);
+      else
+        for (const string &name : batch.names) {
+          SwiftError oneError = deleteOne(_container, name, batch.manifests,
+              batchResult);
+          if (oneError.code != SWIFT_OK.code)
+            batchError = oneError;
+        }
+
+      lock_guard<mutex> guard(progressMutex);
+      total->deleted += batchResult.deleted;
+      total->notFound += batchResult.notFound;
+      total->errors.insert(total->errors.end(), batchResult.errors.begin(),
+          batchResult.errors.end());
+      if (batchError.code != SWIFT_OK.code)
+        error = batchError;
+      progress.objectsDeleted = total->deleted;
+      progress.objectsNotFound = total->notFound;
+      progress.objectsFailed = total->errors.size();
+      progress.bytesProcessed += batch.bytes;
+      Clock::time_point now = Clock::now();
+      progress.elapsedSeconds =
+          chrono::duration<double>(now - start).count();
+      if (_options.onProgress)
+        _options.onProgress(progress);
+      if (_options.onThroughput
+          && now - lastReport >= _options.throughputInterval) {
+        double seconds = chrono::duration<double>(now - lastReport).count();
+        _options.onThroughput(
+            (progress.objectsDeleted - reportedObjects) / seconds,
+            (progress.bytesProcessed - reportedBytes) / seconds);
+        lastReport = now;
+        reportedObjects = progress.objectsDeleted;
+        reportedBytes = progress.bytesProcessed;
+      }
+    }
+  });
+
+  SwiftError listError = listing.get();
+  if (listError.code != SWIFT_OK.code) {
+    result->setError(listError);
+    return result;
+  }
+  if (!total->errors.empty()) {
+    if (error.code == SWIFT_OK.code)
+      error = SwiftError(SwiftError::SWIFT_FAIL,
+          to_string(total->errors.size()) + " objects could not be deleted");
+    result->setError(error);
+    return result;
+  }
+
+  if (_options.deleteContainer) {
+    //Listings are updated asynchronously, so the container may look full
+    //for a moment after its last object went
+    for (int attempt = 0;; attempt++) {
+      SwiftResult<int*> *deleteResult = _container->swiftDeleteContainer();
+      error = deleteResult->getError();
+      bool conflict = deleteResult->getResponse() != nullptr
+          && deleteResult->getResponse()->getStatus()
+              == HTTPResponse::HTTP_CONFLICT;
+      delete deleteResult;
+      if (!conflict || attempt == 4)
+        break;
+      this_thread::sleep_for(chrono::seconds(attempt + 1));
+    }
+  }
+  result->setError(error);
+  return result;
+}
+
+} /* namespace Swift */
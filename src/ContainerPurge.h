@@ -0,0 +1,104 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef CONTAINERPURGE_H_
+#define CONTAINERPURGE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "BulkDelete.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+class Container;
+
+/**
+ * Counters of a running purge
+ */
+struct SWIFTCPP_EXPORT PurgeProgress {
+  uint64_t objectsListed = 0;
+  /**
+   * Includes the segments deleted along with SLO manifests
+   */
+  uint64_t objectsDeleted = 0;
+  uint64_t objectsNotFound = 0;
+  uint64_t objectsFailed = 0;
+  /**
+   * Listed size of the objects whose delete request finished
+   */
+  uint64_t bytesProcessed = 0;
+  double elapsedSeconds = 0;
+};
+
+struct SWIFTCPP_EXPORT PurgeOptions {
+  /**
+   * Number of delete requests in flight at the same time
+   */
+  uint32_t parallelism = 8;
+
+  /**
+   * Delete SLO manifests with multipart-manifest=delete so their segments
+   * go too, wherever they are stored. Needs slo_etag in listings (Swift
+   * 2.16); older clusters only get the manifests deleted.
+   */
+  bool deleteSegments = true;
+
+  /**
+   * Delete the container once it is empty
+   */
+  bool deleteContainer = true;
+
+  /**
+   * Called after every finished batch of deletes
+   */
+  std::function<void(const PurgeProgress &_progress)> onProgress;
+
+  /**
+   * Called at most every throughputInterval with the rates since the
+   * previous call
+   */
+  std::function<void(double _objectsPerSecond, double _bytesPerSecond)> onThroughput;
+  std::chrono::milliseconds throughputInterval = std::chrono::milliseconds(1000);
+};
+
+/**
+ * Empties a container: the listing is read page by page while the objects
+ * listed so far are deleted on PurgeOptions::parallelism connections, with
+ * bulk delete when the cluster offers it and one DELETE per object
+ * otherwise.
+ */
+class SWIFTCPP_EXPORT ContainerPurge {
+private:
+  ContainerPurge() {}
+  ~ContainerPurge() {}
+
+public:
+  /**
+   * @return
+   *  Per object counts and failures; the error is SWIFT_OK only if every
+   *  object (and the container, if asked) was deleted.
+   */
+  static SwiftResult<BulkDeleteResult*>* run(Container *_container,
+      const PurgeOptions &_options);
+};
+
+} /* namespace Swift */
+#endif /* CONTAINERPURGE_H_ */
@@ -0,0 +1,415 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ContentCache.h"
+#include "HTTPIO.h"
+#include "Object.h"
+#include <Poco/MD5Engine.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * File header; the ETag and then the content follow it
+ */
+struct ContentFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t etagLength;
+  uint32_t reserved;
+  uint64_t length;
+};
+
+static const char CONTENT_MAGIC[4] = { 'S', 'W', 'C', 'C' };
+
+struct CachedContent {
+  string etag;
+  shared_ptr<const string> data;
+};
+
+struct ContentCacheState {
+  mutex cacheMutex;
+  string directory;
+  uint64_t memoryLimit;
+  uint64_t maxObjectSize;
+
+  /**
+   * Memory tier: keys from most to least recently used, and the content
+   * with its place in that list
+   */
+  list<string> recentlyUsed;
+  unordered_map<string, pair<CachedContent, list<string>::iterator> > memory;
+  uint64_t memoryUsed;
+
+  atomic<uint64_t> memoryHits;
+  atomic<uint64_t> diskHits;
+  atomic<uint64_t> misses;
+  atomic<uint64_t> bytesSaved;
+  atomic<uint64_t> temporaryFiles;
+
+  ContentCacheState() :
+      memoryLimit(0), maxObjectSize(4 * 1024 * 1024), memoryUsed(0),
+      memoryHits(0), diskHits(0), misses(0), bytesSaved(0),
+      temporaryFiles(0) {
+  }
+};
+
+static ContentCacheState cache;
+
+/**
+ * Read-only stream over cached content, which it keeps alive
+ */
+class CachedContentStream: public istream {
+  class Buffer: public streambuf {
+    shared_ptr<const string> data;
+
+  public:
+    Buffer(const shared_ptr<const string> &_data) :
+        data(_data) {
+      char *begin = const_cast<char*>(data->data());
+      setg(begin, begin, begin + data->size());
+    }
+
+  protected:
+    pos_type seekoff(off_type _offset, ios_base::seekdir _direction,
+        ios_base::openmode _mode) {
+      off_type position = _offset;
+      if (_direction == ios_base::cur)
+        position += gptr() - eback();
+      else if (_direction == ios_base::end)
+        position += egptr() - eback();
+      if (!(_mode & ios_base::in) || position < 0
+          || position > egptr() - eback())
+        return pos_type(off_type(-1));
+      setg(eback(), eback() + position, egptr());
+      return pos_type(position);
+    }
+
+    pos_type seekpos(pos_type _position, ios_base::openmode _mode) {
+      return seekoff(off_type(_position), ios_base::beg, _mode);
+    }
+  };
+  Buffer buffer;
+
+public:
+  CachedContentStream(const shared_ptr<const string> &_data) :
+      istream(nullptr), buffer(_data) {
+    rdbuf(&buffer);
+  }
+};
+
+static bool memoryLookup(const string &_key, CachedContent &_content) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  auto it = cache.memory.find(_key);
+  if (it == cache.memory.end())
+    return false;
+  cache.recentlyUsed.splice(cache.recentlyUsed.begin(), cache.recentlyUsed,
+      it->second.second);
+  _content = it->second.first;
+  return true;
+}
+
+static void memoryErase(const string &_key) {
+  auto it = cache.memory.find(_key);
+  if (it == cache.memory.end())
+    return;
+  cache.memoryUsed -= it->second.first.data->size();
+  cache.recentlyUsed.erase(it->second.second);
+  cache.memory.erase(it);
+}
+
+static void memoryStore(const string &_key, const CachedContent &_content) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  memoryErase(_key);
+  uint64_t size = _content.data->size();
+  //Size-based admission: one object may not flush the whole tier
+  if (size > cache.memoryLimit / 8)
+    return;
+  while (cache.memoryUsed + size > cache.memoryLimit
+      && !cache.recentlyUsed.empty())
+    memoryErase(cache.recentlyUsed.back());
+  cache.recentlyUsed.push_front(_key);
+  cache.memory[_key] = make_pair(_content, cache.recentlyUsed.begin());
+  cache.memoryUsed += size;
+}
+
+static string cacheFileOf(const string &_key, const string &_directory) {
+  MD5Engine md5;
+  md5.update(_key);
+  return _directory + "/" + DigestEngine::digestToHex(md5.digest())
+      + ".content";
+}
+
+/**
+ * Opens a cache file and reads its ETag; the stream is left at the content.
+ */
+static shared_ptr<ifstream> openCacheFile(const string &_path, string &_etag,
+    uint64_t &_length) {
+  shared_ptr<ifstream> input = make_shared<ifstream>(_path.c_str(),
+      ios::binary);
+  ContentFileHeader header;
+  if (!input->read((char*) &header, sizeof(header))
+      || memcmp(header.magic, CONTENT_MAGIC, sizeof(header.magic)) != 0
+      || header.version != 1 || header.etagLength > 1024)
+    return nullptr;
+  _etag.resize(header.etagLength);
+  if (!input->read(&_etag[0], header.etagLength))
+    return nullptr;
+  _length = header.length;
+  return input;
+}
+
+static void writeCacheFile(const string &_path, const CachedContent &_content) {
+  ContentFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CONTENT_MAGIC, sizeof(header.magic));
+  header.version = 1;
+  header.etagLength = _content.etag.size();
+  header.length = _content.data->size();
+
+  //Readers only ever see a complete file
+  string temporary = _path + "." + to_string(getpid()) + "."
+      + to_string(cache.temporaryFiles++) + ".tmp";
+  ofstream output(temporary.c_str(), ios::binary | ios::trunc);
+  output.write((const char*) &header, sizeof(header));
+  output.write(_content.etag.data(), _content.etag.size());
+  output.write(_content.data->data(), _content.data->size());
+  output.close();
+  if (output.fail() || rename(temporary.c_str(), _path.c_str()) != 0)
+    unlink(temporary.c_str());
+}
+
+static void servePayload(SwiftResult<istream*> *_result,
+    const shared_ptr<istream> &_stream) {
+  _result->setPayload(_stream.get());
+  _result->setPayloadOwner(_stream);
+}
+
+/**
+ * _conditional is false to fetch the content again when the cached copy
+ * turned out to be unreadable after the 304.
+ */
+static SwiftResult<istream*>* fetchContent(Object &_object,
+    bool _conditional) {
+  Container *container = _object.getContainer();
+  if (container == nullptr)
+    return returnNullError<istream*>("container");
+  Account *account = container->getAccount();
+  if (account == nullptr)
+    return returnNullError<istream*>("account");
+  string url;
+  if (account->getSwiftService() != nullptr
+      && account->getSwiftService()->getFirstEndpoint() != nullptr)
+    url = account->getSwiftService()->getFirstEndpoint()->getPublicUrl();
+  string path = container->getName() + "/" + _object.getName();
+  string key = url + "\n" + path;
+
+  uint64_t memoryLimit, maxObjectSize;
+  string directory;
+  {
+    lock_guard<mutex> guard(cache.cacheMutex);
+    memoryLimit = cache.memoryLimit;
+    maxObjectSize = cache.maxObjectSize;
+    directory = cache.directory;
+  }
+  string file = directory.empty() ? "" : cacheFileOf(key, directory);
+
+  //The memory tier first, then the disk tier
+  CachedContent cached;
+  shared_ptr<ifstream> cachedFile;
+  uint64_t cachedLength = 0;
+  if (_conditional && memoryLookup(key, cached))
+    cachedLength = cached.data->size();
+  else if (_conditional && !file.empty())
+    cachedFile = openCacheFile(file, cached.etag, cachedLength);
+
+  /**
+   * 200:
+   *  The content, changed or not cached
+   * 304:
+   *  Not Modified, the cached content is current
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_NOT_MODIFIED);
+  vector<HTTPHeader> reqMap;
+  if (!cached.etag.empty())
+    reqMap.push_back(HTTPHeader("If-None-Match", cached.etag));
+
+  SwiftResult<istream*> *result = doSwiftTransaction<istream*>(account, path,
+      HTTPRequest::HTTP_GET, nullptr, &reqMap, &validHTTPCodes);
+  if (result->getError().code != SWIFT_OK.code
+      && result->getError().code != SwiftError::SWIFT_NOT_MODIFIED)
+    return result;
+  HTTPResponse *response = result->getResponse();
+
+  if (result->getError().code == SwiftError::SWIFT_NOT_MODIFIED) {
+    //The content is served after all
+    result->setError(SWIFT_OK);
+    if (cached.data) {
+      cache.memoryHits++;
+      cache.bytesSaved += cachedLength;
+      servePayload(result, make_shared<CachedContentStream>(cached.data));
+      return result;
+    }
+    if (cachedFile) {
+      cache.diskHits++;
+      cache.bytesSaved += cachedLength;
+      //Promote to memory when it fits there
+      if (cachedLength <= memoryLimit / 8) {
+        shared_ptr<string> data = make_shared<string>(cachedLength, '\0');
+        if (cachedLength == 0
+            || cachedFile->read(&(*data)[0], cachedLength)) {
+          cached.data = data;
+          memoryStore(key, cached);
+          servePayload(result, make_shared<CachedContentStream>(cached.data));
+          return result;
+        }
+      } else if (cachedFile->good()) {
+        servePayload(result, cachedFile);
+        return result;
+      }
+    }
+    //The cached copy went away in the meantime
+    delete result;
+    return fetchContent(_object, false);
+  }
+
+  cache.misses++;
+  string etag = response->get("Etag", "");
+  bool admitted = !etag.empty() && response->hasContentLength()
+      && !response->getChunkedTransferEncoding()
+      && (uint64_t) response->getContentLength64() <= maxObjectSize
+      && (memoryLimit > 0 || !file.empty());
+  if (!admitted) {
+    {
+      lock_guard<mutex> guard(cache.cacheMutex);
+      memoryErase(key);
+    }
+    if (!file.empty())
+      unlink(file.c_str());
+    return result;
+  }
+
+  //Read the whole body so it can be kept
+  uint64_t length = response->getContentLength64();
+  shared_ptr<string> data = make_shared<string>(length, '\0');
+  if (length > 0 && !result->getPayload()->read(&(*data)[0], length)) {
+    result->setError(SwiftError(SwiftError::SWIFT_EXCEPTION,
+        "Connection closed after " + to_string(result->getPayload()->gcount())
+            + " of " + to_string(length) + " bytes"));
+    result->setPayload(nullptr);
+    return result;
+  }
+  CachedContent content;
+  content.etag = etag;
+  content.data = data;
+  if (memoryLimit > 0)
+    memoryStore(key, content);
+  if (!file.empty())
+    writeCacheFile(file, content);
+  servePayload(result, make_shared<CachedContentStream>(content.data));
+  return result;
+}
+
+SwiftResult<istream*>* ContentCache::getContent(Object &_object) {
+  return fetchContent(_object, true);
+}
+
+void ContentCache::setMemoryLimit(uint64_t _bytes) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  cache.memoryLimit = _bytes;
+  while (cache.memoryUsed > cache.memoryLimit)
+    memoryErase(cache.recentlyUsed.back());
+}
+
+uint64_t ContentCache::getMemoryLimit() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.memoryLimit;
+}
+
+void ContentCache::setDirectory(const string &_directory) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  cache.directory = _directory;
+}
+
+string ContentCache::getDirectory() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.directory;
+}
+
+void ContentCache::setMaxObjectSize(uint64_t _bytes) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  cache.maxObjectSize = _bytes;
+}
+
+uint64_t ContentCache::getMaxObjectSize() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.maxObjectSize;
+}
+
+bool ContentCache::isEnabled() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.memoryLimit > 0 || !cache.directory.empty();
+}
+
+void ContentCache::clear() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  cache.memory.clear();
+  cache.recentlyUsed.clear();
+  cache.memoryUsed = 0;
+  cache.memoryHits = 0;
+  cache.diskHits = 0;
+  cache.misses = 0;
+  cache.bytesSaved = 0;
+}
+
+uint64_t ContentCache::getMemoryHits() {
+  return cache.memoryHits;
+}
+
+uint64_t ContentCache::getDiskHits() {
+  return cache.diskHits;
+}
+
+uint64_t ContentCache::getMisses() {
+  return cache.misses;
+}
+
+uint64_t ContentCache::getBytesSaved() {
+  return cache.bytesSaved;
+}
+
+uint64_t ContentCache::getMemoryUsage() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.memoryUsed;
+}
+
+} /* namespace Swift */
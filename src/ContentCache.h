@@ -0,0 +1,107 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef CONTENTCACHE_H_
+#define CONTENTCACHE_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "SwiftResult.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+class Object;
+
+/**
+ * Optional read-through cache of object content with two tiers: a memory
+ * LRU bounded in bytes, and files in a directory of the caller's choice
+ * (one per object, never evicted by the SDK). Each read still asks the
+ * server, with If-None-Match set to the cached ETag: an unchanged object
+ * costs a 304 without a body and is served from the cache.
+ *
+ * Disabled until a memory limit or a directory is set;
+ * Object::swiftGetObjectContent uses it for plain (not ranged) reads once
+ * enabled. Objects without a Content-Length or bigger than the maximum
+ * object size are streamed as usual and not cached.
+ */
+class SWIFTCPP_EXPORT ContentCache {
+private:
+  ContentCache() {}
+  ~ContentCache() {}
+
+public:
+  /**
+   * Bytes of content kept in memory; 0 (default) turns the memory tier off.
+   */
+  static void setMemoryLimit(uint64_t _bytes);
+  static uint64_t getMemoryLimit();
+
+  /**
+   * Directory of the cache files, which must exist; "" (default) turns
+   * the disk tier off.
+   */
+  static void setDirectory(const std::string &_directory);
+  static std::string getDirectory();
+
+  /**
+   * Largest object admitted to the cache (default 4MB); objects larger
+   * than an eighth of the memory limit only go to disk.
+   */
+  static void setMaxObjectSize(uint64_t _bytes);
+  static uint64_t getMaxObjectSize();
+
+  static bool isEnabled();
+
+  /**
+   * GETs _object, revalidating a cached copy. On a hit the response is
+   * the server's 304 and the payload streams the cached content.
+   */
+  static SwiftResult<std::istream*>* getContent(Object &_object);
+
+  /**
+   * Drops everything from the memory tier and the statistics; files stay.
+   */
+  static void clear();
+
+  /**
+   * Reads answered by a 304 from the memory or the disk tier
+   */
+  static uint64_t getMemoryHits();
+  static uint64_t getDiskHits();
+
+  /**
+   * Reads which got the content from the server
+   */
+  static uint64_t getMisses();
+
+  /**
+   * Content bytes not transferred thanks to 304s
+   */
+  static uint64_t getBytesSaved();
+
+  /**
+   * Bytes currently held by the memory tier
+   */
+  static uint64_t getMemoryUsage();
+};
+
+} /* namespace Swift */
+#endif /* CONTENTCACHE_H_ */
@@ -39,6 +39,10 @@ struct SWIFTCPP_EXPORT SwiftError
   static const int SWIFT_EXCEPTION = -2; //Exception happened
   static const int SWIFT_HTTP_ERROR = -3; //HTTP erro happened
   static const int SWIFT_JSON_PARSE_ERROR = -3; //JSON Parsing Error happened
+  static const int SWIFT_CHECKSUM_ERROR = -4; //Data does not match its ETag
+  /** Outcomes of conditional requests, not failures **/
+  static const int SWIFT_NOT_MODIFIED = 1; //304, the cached copy is current
+  static const int SWIFT_PRECONDITION_FAILED = 2; //412, condition did not hold
 };
 
 //Always the same message
@@ -0,0 +1,113 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "Executor.h"
+
+using namespace std;
+
+namespace Swift {
+
+Executor::Executor(uint32_t _numThreads) :
+    numThreads(0), numRunning(0), stopping(false) {
+  setNumThreads(_numThreads);
+}
+
+Executor::~Executor() {
+  {
+    lock_guard<mutex> guard(queueMutex);
+    stopping = true;
+  }
+  queueCondition.notify_all();
+  for (thread &worker : workers)
+    worker.join();
+  workers.clear();
+}
+
+void Executor::workerLoop() {
+  while (true) {
+    function<void()> task;
+    {
+      unique_lock<mutex> lock(queueMutex);
+      queueCondition.wait(lock, [this]() {
+        return stopping || !tasks.empty() || numRunning > numThreads;
+      });
+      //Shrinking or stopping with nothing left to do
+      if (numRunning > numThreads || (stopping && tasks.empty())) {
+        numRunning--;
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void Executor::execute(const function<void()> &_task) {
+  {
+    lock_guard<mutex> guard(queueMutex);
+    tasks.push_back(_task);
+  }
+  queueCondition.notify_one();
+}
+
+void Executor::setNumThreads(uint32_t _numThreads) {
+  if (_numThreads == 0)
+    _numThreads = 1;
+  lock_guard<mutex> guard(queueMutex);
+  numThreads = _numThreads;
+  while (numRunning < numThreads) {
+    workers.push_back(thread(&Executor::workerLoop, this));
+    numRunning++;
+  }
+  queueCondition.notify_all();
+}
+
+uint32_t Executor::getNumThreads() {
+  lock_guard<mutex> guard(queueMutex);
+  return numThreads;
+}
+
+size_t Executor::getQueueSize() {
+  lock_guard<mutex> guard(queueMutex);
+  return tasks.size();
+}
+
+Executor& Executor::getDefault() {
+  static Executor defaultExecutor(32);
+  return defaultExecutor;
+}
+
+void Executor::setDefaultThreads(uint32_t _numThreads) {
+  getDefault().setNumThreads(_numThreads);
+}
+
+void runOnThreads(uint32_t _numThreads, const function<void()> &_worker) {
+  if (_numThreads <= 1) {
+    _worker();
+    return;
+  }
+  vector<thread> threads;
+  for (uint32_t i = 0; i < _numThreads; i++)
+    threads.push_back(thread(_worker));
+  for (thread &worker : threads)
+    worker.join();
+}
+
+} /* namespace Swift */
@@ -0,0 +1,121 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Fixed size thread pool which runs the ...Async API functions. Swift calls
+ * block on the network, so the number of threads is the number of requests
+ * which can be in flight at the same time.
+ */
+class SWIFTCPP_EXPORT Executor {
+private:
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()> > tasks;
+  std::mutex queueMutex;
+  std::condition_variable queueCondition;
+
+  /**
+   * Number of threads which should be running
+   */
+  uint32_t numThreads;
+
+  /**
+   * Number of threads currently running
+   */
+  uint32_t numRunning;
+  bool stopping;
+
+  void workerLoop();
+
+public:
+  Executor(uint32_t _numThreads);
+
+  /**
+   * Runs the queued tasks and joins all threads
+   */
+  virtual ~Executor();
+
+  /**
+   * Queues a task; it runs on one of the executor threads.
+   */
+  void execute(const std::function<void()> &_task);
+
+  /**
+   * Queues a task and returns a future for its return value.
+   */
+  template<class F>
+  std::future<typename std::result_of<F()>::type> submit(F _func) {
+    typedef typename std::result_of<F()>::type R;
+    std::shared_ptr<std::packaged_task<R()> > task = std::make_shared<
+        std::packaged_task<R()> >(_func);
+    std::future<R> result = task->get_future();
+    execute([task]() {(*task)();});
+    return result;
+  }
+
+  /**
+   * Grows or shrinks the number of threads; shrinking takes effect once
+   * the extra threads finish their current task.
+   */
+  void setNumThreads(uint32_t _numThreads);
+  uint32_t getNumThreads();
+
+  /**
+   * Number of tasks waiting for a free thread
+   */
+  size_t getQueueSize();
+
+  /**
+   * The SDK-wide executor used by the ...Async functions (32 threads
+   * unless configured otherwise).
+   */
+  static Executor& getDefault();
+
+  /**
+   * Sets the number of threads of the default executor.
+   */
+  static void setDefaultThreads(uint32_t _numThreads);
+};
+
+/**
+ * Runs _worker on _numThreads dedicated threads and waits for all of them.
+ * Parallel transfers use this instead of the Executor so they never wait
+ * for threads of the Executor they may themselves be running on.
+ */
+SWIFTCPP_EXPORT void runOnThreads(uint32_t _numThreads,
+    const std::function<void()> &_worker);
+
+} /* namespace Swift */
+#endif /* EXECUTOR_H_ */
@@ -19,8 +19,14 @@
 
 #include "HTTPIO.h"
 #include <sstream>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <Poco/DigestEngine.h>
 #include "Logger.h"
+#include "SessionPool.h"
+#include "ArchiveUpload.h"
+#include "BulkDelete.h"
 
 namespace Swift {
 
@@ -28,13 +34,31 @@ using namespace std;
 using namespace Poco::Net;
 using namespace Poco;
 
-recursive_mutex transactionMutex;
+static atomic<uint64_t> expectContinueThreshold(1024 * 1024);
+static atomic<Timespan::TimeDiff> expectContinueTimeout(Timespan::SECONDS);
+
+void setExpectContinueThreshold(uint64_t _threshold) {
+  expectContinueThreshold = _threshold;
+}
+
+uint64_t getExpectContinueThreshold() {
+  return expectContinueThreshold;
+}
+
+void setExpectContinueTimeout(const Timespan &_timeout) {
+  expectContinueTimeout = _timeout.totalMicroseconds();
+}
+
+Timespan getExpectContinueTimeout() {
+  return Timespan(expectContinueTimeout);
+}
 
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
     const std::string& type, std::vector<HTTPHeader>* params) {
-  Poco::Net::HTTPClientSession *session = new HTTPClientSession(uri.getHost(),
-      uri.getPort());
-  Poco::Net::HTTPRequest request(type, uri.getPathAndQuery());
+  Poco::Net::HTTPClientSession *session = HTTPSessionPool::acquire(uri);
+  Poco::Net::HTTPRequest request(type, uri.getPathAndQuery(),
+      HTTPMessage::HTTP_1_1);
+  request.setKeepAlive(true);
 
   //Add params
   if (params != nullptr && params->size() > 0) {
@@ -53,9 +77,9 @@ Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
     const std::string& type, std::vector<HTTPHeader>* params,
     const std::string& reqBody, const std::string& contentType) {
-  HTTPClientSession *session = new HTTPClientSession(uri.getHost(),
-      uri.getPort());
-  HTTPRequest request(type, uri.getPathAndQuery());
+  HTTPClientSession *session = HTTPSessionPool::acquire(uri);
+  HTTPRequest request(type, uri.getPathAndQuery(), HTTPMessage::HTTP_1_1);
+  request.setKeepAlive(true);
   //Set Content Type
   request.setContentLength(reqBody.size());
   request.setContentType(contentType);
@@ -79,12 +103,26 @@ Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
 
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
     const std::string& type, std::vector<HTTPHeader>* params,
-    const char* reqBody, uint32_t size, const std::string& contentType) {
-  HTTPClientSession *session = new HTTPClientSession(uri.getHost(),
-      uri.getPort());
-  HTTPRequest request(type, uri.getPathAndQuery());
+    const char* reqBody, uint64_t size, const std::string& contentType,
+    bool verifyETag) {
+  MemoryBodySource body(reqBody, size);
+  return doHTTPIO(uri, type, params, body, contentType, verifyETag);
+}
+
+Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
+    const std::string& type, std::vector<HTTPHeader>* params,
+    BodySource& reqBody, const std::string& contentType, bool verifyETag) {
+  PooledHTTPClientSession *session = HTTPSessionPool::acquire(uri);
+  HTTPRequest request(type, uri.getPathAndQuery(), HTTPMessage::HTTP_1_1);
+  request.setKeepAlive(true);
   //Set Content size
+  uint64_t size = reqBody.size();
   request.setContentLength(size);
+  //Large bodies wait for the server to accept the request first
+  uint64_t threshold = expectContinueThreshold;
+  bool expectContinue = threshold > 0 && size >= threshold;
+  if (expectContinue)
+    request.setExpectContinue(true);
   //Content Type
   if(contentType.length() != 0)
     request.setContentType(contentType);
@@ -102,16 +140,64 @@ Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
   ostream &ostream = session->sendRequest(request);
   if (!ostream.good())
     return nullptr;
-  ostream << reqBody;
+  //Headers may still sit in the request stream buffer
+  ostream.flush();
+  try {
+    if (expectContinue
+        && !session->waitForContinue(getExpectContinueTimeout()))
+      return session;
+  } catch (...) {
+    delete session;
+    throw;
+  }
+  DigestEngine *digest = verifyETag ? &session->verifyUploadETag() : nullptr;
+  //Contiguous bodies go straight from the caller's memory, others are
+  //pulled chunk by chunk; both skip the stream buffer.
+  //Each chunk is hashed right before it goes out.
+  const uint64_t chunkSize = 1024 * 1024;
+  const char *contiguous = reqBody.data();
+  vector<char> buffer(contiguous == nullptr ? min(chunkSize, size) : 0);
+  try {
+    for (uint64_t offset = 0; offset < size;) {
+      const char *chunk = buffer.data();
+      int length = min(chunkSize, size - offset);
+      if (contiguous != nullptr)
+        chunk = contiguous + offset;
+      else {
+        length = reqBody.read(buffer.data(), length);
+        //Content-Length is already out: the connection cannot be reused
+        if (length == 0)
+          throw Poco::IOException("Request body ended after "
+              + to_string(offset) + " of " + to_string(size) + " bytes");
+      }
+      if (digest != nullptr)
+        digest->update(chunk, length);
+      //A blocking send may still come back short; keep going until the
+      //whole chunk is out, a send making no progress is a dead connection
+      for (int sent = 0; sent < length;) {
+        int n = session->socket().sendBytes(chunk + sent, length - sent);
+        if (n <= 0)
+          throw Poco::IOException("Connection closed after "
+              + to_string(offset + sent) + " of " + to_string(size)
+              + " request body bytes");
+        sent += n;
+      }
+      offset += length;
+    }
+  } catch (...) {
+    //Half sent request: this session is of no use to anyone
+    delete session;
+    throw;
+  }
   return session;
 }
 
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
     const std::string& type, std::vector<HTTPHeader>* params,
-    std::ostream* &outputStream) {
-  HTTPClientSession *session = new HTTPClientSession(uri.getHost(),
-      uri.getPort());
-  HTTPRequest request(type, uri.getPathAndQuery());
+    std::ostream* &outputStream, bool verifyETag) {
+  PooledHTTPClientSession *session = HTTPSessionPool::acquire(uri);
+  HTTPRequest request(type, uri.getPathAndQuery(), HTTPMessage::HTTP_1_1);
+  request.setKeepAlive(true);
 
   //Add params
   if (params != nullptr && params->size() > 0) {
@@ -124,14 +210,52 @@ Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI& uri,
 
   //Ouput stream
   outputStream = &session->sendRequest(request);
+  if (verifyETag)
+    outputStream = &session->hashRequestBody(*outputStream);
 
   return session;
 }
 
+string buildQuery(vector<HTTPHeader> *_uriParams) {
+  //Object names in markers may hold any of these
+  static const string reserved = "!#$&'()*+,/:;=?@[]";
+  ostringstream queryStream;
+  if (_uriParams == nullptr)
+    return "";
+  for (unsigned int i = 0; i < _uriParams->size(); i++) {
+    string key, value;
+    URI::encode(_uriParams->at(i).getKey(), reserved, key);
+    URI::encode(_uriParams->at(i).getValue(), reserved, value);
+    if (i > 0)
+      queryStream << "&";
+    queryStream << key << "=" << value;
+  }
+  return queryStream.str();
+}
+
+string normalizeETag(const string &_etag) {
+  string etag = _etag;
+  if (etag.size() >= 2 && etag[0] == '"' && etag[etag.size() - 1] == '"')
+    etag = etag.substr(1, etag.size() - 2);
+  transform(etag.begin(), etag.end(), etag.begin(), ::tolower);
+  return etag;
+}
+
+shared_ptr<vector<HTTPHeader> > copyHeaders(
+    const vector<HTTPHeader> *_headers) {
+  if (_headers == nullptr)
+    return nullptr;
+  return make_shared<vector<HTTPHeader> >(*_headers);
+}
+
 /** Template instantiation for common used types **/
 template SwiftResult<int*>* returnNullError<int*>(const string &whatsNull);
 template SwiftResult<istream*>* returnNullError<istream*>(const string &whatsNull);
 template SwiftResult<HTTPClientSession*>* returnNullError<HTTPClientSession*>(const string &whatsNull);
+template SwiftResult<uint64_t*>* returnNullError<uint64_t*>(const string &whatsNull);
+template SwiftResult<BulkDeleteResult*>* returnNullError<BulkDeleteResult*>(const string &whatsNull);
+template SwiftResult<ArchiveUploadResult*>* returnNullError<ArchiveUploadResult*>(const string &whatsNull);
+template SwiftResult<ObjectStat*>* returnNullError<ObjectStat*>(const string &whatsNull);
 
 template<class T>
 inline SwiftResult<T>* returnNullError(const string &whatsNull) {
@@ -148,23 +272,40 @@ template
 SwiftResult<istream*>* doSwiftTransaction<istream*>(Account *_account,
     std::string &_uriPath, const std::string &_method,
     std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
-    std::vector<int> *_httpValidCodes, const char *bodyReqBuffer, uint32_t size,
-    std::string *contentType);
+    std::vector<int> *_httpValidCodes, const char *bodyReqBuffer, uint64_t size,
+    std::string *contentType, bool _verifyETag);
 
 template
 SwiftResult<int*>* doSwiftTransaction<int*>(Account *_account,
     std::string &_uriPath, const std::string &_method,
     std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
-    std::vector<int> *_httpValidCodes, const char *bodyReqBuffer, uint32_t size,
-    std::string *contentType);
+    std::vector<int> *_httpValidCodes, const char *bodyReqBuffer, uint64_t size,
+    std::string *contentType, bool _verifyETag);
+
+template
+SwiftResult<istream*>* doSwiftTransaction<istream*>(Account *_account,
+    std::string &_uriPath, const std::string &_method,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
+    std::vector<int> *_httpValidCodes, BodySource &_body,
+    std::string *contentType, bool _verifyETag);
 
+template
+SwiftResult<int*>* doSwiftTransaction<int*>(Account *_account,
+    std::string &_uriPath, const std::string &_method,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
+    std::vector<int> *_httpValidCodes, BodySource &_body,
+    std::string *contentType, bool _verifyETag);
+
+/**
+ * Shared by both doSwiftTransaction flavours; _body is nullptr for requests
+ * without a body.
+ */
 template<class T>
-SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
-    const std::string &_method, std::vector<HTTPHeader>* _uriParams,
-    std::vector<HTTPHeader>* _reqMap, std::vector<int> *_httpValidCodes,
-    const char *bodyReqBuffer, uint32_t size, std::string *contentType) {
-  //Start locking
-  lock_guard<recursive_mutex> guard(transactionMutex);
+static SwiftResult<T>* swiftTransaction(Account *_account,
+    std::string &_uriPath, const std::string &_method,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
+    std::vector<int> *_httpValidCodes, BodySource *_body,
+    std::string *contentType, bool _verifyETag) {
   //Start of function
   if (_account == nullptr)
     return returnNullError<T>("account");
@@ -175,7 +316,7 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
   //Create parameter map
   vector<HTTPHeader> reqParamMap;
   //Add authentication token
-  string tokenID = _account->getToken()->getId();
+  string tokenID = _account->getTokenID();
   HTTPHeader authHeader("X-Auth-Token", tokenID);
   reqParamMap.push_back(authHeader);
   //Add rest of request Parameters
@@ -186,25 +327,17 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
   }
 
   URI uri(swiftEndpoint->getPublicUrl());
+  //Encode a copy; _uriPath is reused as is if we have to retry
   string encoded;
   URI::encode(_uriPath,"",encoded);
-  _uriPath = encoded;
   if (uri.getPath().size() > 0)
-    uri.setPath(uri.getPath() + "/" + _uriPath);
+    uri.setPath(uri.getPath() + "/" + encoded);
   else
-    uri.setPath(_uriPath);
-
-  if (_uriParams != nullptr && _uriParams->size() > 0) {
-    //Create appropriate URI
-    ostringstream queryStream;
-    //queryStream << "?";
-    for (unsigned int i = 0; i < _uriParams->size(); i++) {
-      if (i > 0)
-        queryStream << ",";
-      queryStream << _uriParams->at(i).getQueryValue();
-    }
-    uri.setQuery(queryStream.str());
-  }
+    uri.setPath(encoded);
+
+  //Already encoded: setQuery() would encode '%' again
+  if (_uriParams != nullptr && _uriParams->size() > 0)
+    uri.setRawQuery(buildQuery(_uriParams));
 
   //Creating HTTP Session
   HTTPResponse *httpResponse = new HTTPResponse();
@@ -213,14 +346,15 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
 
   try {
     /** This operation does not accept a request body. **/
-    if (bodyReqBuffer == nullptr)
+    if (_body == nullptr)
       httpSession = doHTTPIO(uri, _method, &reqParamMap);
     else {
       if (contentType != nullptr)
-        httpSession = doHTTPIO(uri, _method, &reqParamMap, bodyReqBuffer, size,
-            *contentType);
+        httpSession = doHTTPIO(uri, _method, &reqParamMap, *_body,
+            *contentType, _verifyETag);
       else
-        httpSession = doHTTPIO(uri, _method, &reqParamMap, bodyReqBuffer, size,"");
+        httpSession = doHTTPIO(uri, _method, &reqParamMap, *_body, "",
+            _verifyETag);
     }
 
     //Now we should increase number of calls to SWIFT API
@@ -256,11 +390,13 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
     if(httpResponse->getStatus() == 200)
       Logger::SWIFT_ERROR()<<"bullshit"<<endl;
     if(httpResponse->getStatus() == HTTPResponse::HTTP_UNAUTHORIZED) {
-      if(_account->reAuthenticate()) {
-        delete httpSession;httpSession = nullptr;
+      //The body is sent again from its first byte
+      if((_body == nullptr || _body->rewind())
+          && _account->reAuthenticate(tokenID)) {
+        HTTPSessionPool::release(httpSession);httpSession = nullptr;
         delete httpResponse;httpResponse = nullptr;
-        return doSwiftTransaction<T>(_account, _uriPath,_method, _uriParams,
-            _reqMap, _httpValidCodes, bodyReqBuffer, size, contentType);
+        return swiftTransaction<T>(_account, _uriPath,_method, _uriParams,
+            _reqMap, _httpValidCodes, _body, contentType, _verifyETag);
       }
     }
     SwiftResult<T> *result = new SwiftResult<T>();
@@ -276,7 +412,15 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
 
   //Everything seems fine
   SwiftResult<T> *result = new SwiftResult<T>();
-  result->setError(SWIFT_OK);
+  //Conditions which did not hold are outcomes the caller asked for
+  if (httpResponse->getStatus() == HTTPResponse::HTTP_NOT_MODIFIED)
+    result->setError(SwiftError(SwiftError::SWIFT_NOT_MODIFIED,
+        "Not Modified"));
+  else if (httpResponse->getStatus() == HTTPResponse::HTTP_PRECONDITION_FAILED)
+    result->setError(SwiftError(SwiftError::SWIFT_PRECONDITION_FAILED,
+        "Precondition Failed"));
+  else
+    result->setError(SWIFT_OK);
   result->setSession(httpSession);
   result->setResponse(httpResponse);
   result->setPayload((T)resultStream);
@@ -284,4 +428,57 @@ SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
   return result;
 }
 
+/**
+ * Drops the stat cache entries of the objects a request may have changed,
+ * once it has been answered.
+ */
+static void invalidateStats(Account *_account, const string &_uriPath,
+    const string &_method, vector<HTTPHeader>* _reqMap) {
+  if (_account == nullptr || _method == HTTPRequest::HTTP_GET
+      || _method == HTTPRequest::HTTP_HEAD)
+    return;
+  shared_ptr<StatCache> statCache = _account->getStatCache();
+  if (!statCache)
+    return;
+  statCache->invalidate(_uriPath);
+  if (_method == "COPY" && _reqMap != nullptr)
+    for (HTTPHeader &header : *_reqMap)
+      if (header.getKey() == "Destination") {
+        const string &destination = header.getValue();
+        statCache->invalidate(
+            !destination.empty() && destination[0] == '/' ?
+                destination.substr(1) : destination);
+      }
+}
+
+template<class T>
+SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
+    const std::string &_method, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap, std::vector<int> *_httpValidCodes,
+    const char *bodyReqBuffer, uint64_t size, std::string *contentType,
+    bool _verifyETag) {
+  SwiftResult<T> *result;
+  if (bodyReqBuffer == nullptr)
+    result = swiftTransaction<T>(_account, _uriPath, _method, _uriParams,
+        _reqMap, _httpValidCodes, nullptr, contentType, _verifyETag);
+  else {
+    MemoryBodySource body(bodyReqBuffer, size);
+    result = swiftTransaction<T>(_account, _uriPath, _method, _uriParams,
+        _reqMap, _httpValidCodes, &body, contentType, _verifyETag);
+  }
+  invalidateStats(_account, _uriPath, _method, _reqMap);
+  return result;
+}
+
+template<class T>
+SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
+    const std::string &_method, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap, std::vector<int> *_httpValidCodes,
+    BodySource &_body, std::string *contentType, bool _verifyETag) {
+  SwiftResult<T> *result = swiftTransaction<T>(_account, _uriPath, _method,
+      _uriParams, _reqMap, _httpValidCodes, &_body, contentType, _verifyETag);
+  invalidateStats(_account, _uriPath, _method, _reqMap);
+  return result;
+}
+
 } /* namespace Swift */
@@ -30,10 +30,12 @@
 #include <Poco/HashMap.h>
 #include <Poco/URI.h>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include "Header.h"
 #include "SwiftResult.h"
 #include "Account.h"
+#include "BodySource.h"
 #include "swiftcpp_export.h"
 
 namespace Swift {
@@ -45,21 +47,72 @@ Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI &uri,
     const std::string &reqBody, const std::string &contentType);
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI &uri,
     const std::string &type, std::vector<HTTPHeader> *params,
-    const char* reqBody, uint32_t size, const std::string& contentType);
+    const char* reqBody, uint64_t size, const std::string& contentType,
+    bool verifyETag = false);
 Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI &uri,
     const std::string &type, std::vector<HTTPHeader> *params,
-    std::ostream* &outputStream);
+    BodySource &reqBody, const std::string& contentType,
+    bool verifyETag = false);
+Poco::Net::HTTPClientSession* doHTTPIO(const Poco::URI &uri,
+    const std::string &type, std::vector<HTTPHeader> *params,
+    std::ostream* &outputStream, bool verifyETag = false);
+
+template<class T>
+SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
+    const std::string &_method, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap, std::vector<int> *_httpValidCodes,
+    const char *bodyReqBuffer = nullptr, uint64_t size = 0,
+    std::string *contentType = nullptr, bool _verifyETag = false);
 
+/**
+ * Same as above with a body pulled from _body; it is rewound and sent again
+ * if the request has to be retried after re-authentication.
+ */
 template<class T>
 SwiftResult<T>* doSwiftTransaction(Account *_account, std::string &_uriPath,
     const std::string &_method, std::vector<HTTPHeader>* _uriParams,
     std::vector<HTTPHeader>* _reqMap, std::vector<int> *_httpValidCodes,
-    const char *bodyReqBuffer = nullptr, uint32_t size = 0,
-    std::string *contentType = nullptr);
+    BodySource &_body, std::string *contentType = nullptr,
+    bool _verifyETag = false);
 
 template<class T>
 SwiftResult<T>* returnNullError(const std::string &whatsNull);
 
+/**
+ * Request bodies of at least this many bytes are sent with
+ * Expect: 100-continue, so an expired token, a full quota or a failed
+ * precondition is answered before any body byte goes out (default 1MB).
+ * Zero disables it.
+ */
+void setExpectContinueThreshold(uint64_t _threshold);
+uint64_t getExpectContinueThreshold();
+
+/**
+ * How long to wait for 100 Continue before sending the body anyway
+ * (default 1 second).
+ */
+void setExpectContinueTimeout(const Poco::Timespan &_timeout);
+Poco::Timespan getExpectContinueTimeout();
+
+/**
+ * Joins _uriParams into a query string with their keys and values
+ * percent-encoded; returns "" for nullptr.
+ */
+std::string buildQuery(std::vector<HTTPHeader> *_uriParams);
+
+/**
+ * Swift returns the ETag of a plain object as lowercase hex, which proxies
+ * may quote; returns it unquoted and lowercase.
+ */
+std::string normalizeETag(const std::string &_etag);
+
+/**
+ * Copies optional request parameters so they outlive the caller when the
+ * request runs later on an Executor; returns nullptr for nullptr.
+ */
+std::shared_ptr<std::vector<HTTPHeader> > copyHeaders(
+    const std::vector<HTTPHeader> *_headers);
+
 } /* namespace Swift */
 
 #endif /* HTTPIO_H_ */
@@ -0,0 +1,285 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ListingCache.h"
+#include "HTTPIO.h"
+#include "ObjectIterator.h"
+#include <Poco/MD5Engine.h>
+#include <Poco/NumberParser.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * Container state recorded with a cached listing
+ */
+struct ContainerState {
+  int64_t objectCount = -1;
+  int64_t bytesUsed = -1;
+  string lastModified;
+
+  bool operator==(const ContainerState &_other) const {
+    return objectCount == _other.objectCount
+        && bytesUsed == _other.bytesUsed
+        && lastModified == _other.lastModified;
+  }
+};
+
+/**
+ * File header; the ObjectListing follows it
+ */
+struct CacheFileHeader {
+  char magic[4];
+  uint32_t version;
+  int64_t objectCount;
+  int64_t bytesUsed;
+  char lastModified[64];
+};
+
+static const char CACHE_MAGIC[4] = { 'S', 'W', 'L', 'C' };
+
+struct CacheState {
+  mutex cacheMutex;
+  string directory;
+  atomic<uint64_t> hits;
+  atomic<uint64_t> incremental;
+  atomic<uint64_t> misses;
+  atomic<uint64_t> temporaryFiles;
+
+  CacheState() :
+      hits(0), incremental(0), misses(0), temporaryFiles(0) {
+  }
+};
+
+static CacheState cache;
+
+static string cacheFileOf(Container &_container, const string &_directory) {
+  string url;
+  Account *account = _container.getAccount();
+  if (account != nullptr && account->getSwiftService() != nullptr
+      && account->getSwiftService()->getFirstEndpoint() != nullptr)
+    url = account->getSwiftService()->getFirstEndpoint()->getPublicUrl();
+  MD5Engine md5;
+  md5.update(url + "\n" + _container.getName());
+  return _directory + "/" + DigestEngine::digestToHex(md5.digest())
+      + ".listing";
+}
+
+static bool readCacheFile(const string &_path, ContainerState &_state,
+    ObjectListing &_listing) {
+  int fd = open(_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0
+      || (uint64_t) fileStat.st_size < sizeof(CacheFileHeader)) {
+    close(fd);
+    return false;
+  }
+  void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  CacheFileHeader header;
+  memcpy(&header, data, sizeof(header));
+  bool ok = memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0
+      && header.version == 1;
+  if (ok) {
+    header.lastModified[sizeof(header.lastModified) - 1] = '\0';
+    _state.objectCount = header.objectCount;
+    _state.bytesUsed = header.bytesUsed;
+    _state.lastModified = header.lastModified;
+    ok = _listing.readFrom((const char*) data + sizeof(header),
+        fileStat.st_size - sizeof(header));
+  }
+  munmap(data, fileStat.st_size);
+  return ok;
+}
+
+static void writeCacheFile(const string &_path, const ContainerState &_state,
+    const ObjectListing &_listing) {
+  CacheFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+  header.version = 1;
+  header.objectCount = _state.objectCount;
+  header.bytesUsed = _state.bytesUsed;
+  strncpy(header.lastModified, _state.lastModified.c_str(),
+      sizeof(header.lastModified) - 1);
+
+  //Readers only ever see a complete file
+  string temporary = _path + "." + to_string(getpid()) + "."
+      + to_string(cache.temporaryFiles++) + ".tmp";
+  ofstream output(temporary.c_str(), ios::binary | ios::trunc);
+  output.write((const char*) &header, sizeof(header));
+  bool ok = output.good() && _listing.writeTo(output);
+  output.close();
+  if (!ok || rename(temporary.c_str(), _path.c_str()) != 0)
+    unlink(temporary.c_str());
+}
+
+/**
+ * Appends the objects after _marker to _listing
+ */
+static SwiftError listAfter(Container &_container, const string &_marker,
+    bool _newest, ObjectListing &_listing, uint64_t &_added,
+    uint64_t &_addedBytes) {
+  const uint32_t pageSize = 10000;
+  string marker = _marker;
+  uint32_t entries = pageSize;
+  SwiftError error = SWIFT_OK;
+  _added = _addedBytes = 0;
+  while (entries == pageSize && error.code == SWIFT_OK.code)
+    error = ObjectIterator::fetchEntries(&_container, pageSize, "", marker, "",
+        _newest, [&](const ListingEntry &_entry) {
+          _listing.add(_entry);
+          _added++;
+          _addedBytes += _entry.bytes;
+          marker = _entry.name;
+          return true;
+        }, entries);
+  return error;
+}
+
+void ListingCache::setDirectory(const std::string &_directory) {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  cache.directory = _directory;
+}
+
+std::string ListingCache::getDirectory() {
+  lock_guard<mutex> guard(cache.cacheMutex);
+  return cache.directory;
+}
+
+bool ListingCache::isEnabled() {
+  return !getDirectory().empty();
+}
+
+SwiftResult<ObjectListing*>* ListingCache::getListing(Container &_container,
+    bool _newest) {
+  SwiftResult<ObjectListing*> *result = new SwiftResult<ObjectListing*>();
+  result->setPayload(nullptr);
+
+  //HEAD: cheap whatever the size of the container
+  SwiftResult<int*> *head = _container.swiftShowMetadata(_newest);
+  if (head->getError().code != SWIFT_OK.code) {
+    result->setError(head->getError());
+    delete head;
+    return result;
+  }
+  ContainerState current;
+  HTTPResponse *response = head->getResponse();
+  Int64 value;
+  if (NumberParser::tryParse64(response->get("X-Container-Object-Count", ""),
+      value))
+    current.objectCount = value;
+  if (NumberParser::tryParse64(response->get("X-Container-Bytes-Used", ""),
+      value))
+    current.bytesUsed = value;
+  current.lastModified = response->get("Last-Modified",
+      response->get("X-PUT-Timestamp", ""));
+  delete head;
+
+  string directory = getDirectory();
+  string path = cacheFileOf(_container, directory);
+  ObjectListing *listing = new ObjectListing(&_container);
+  ContainerState cached;
+  bool haveCache = !directory.empty()
+      && readCacheFile(path, cached, *listing);
+
+  if (haveCache && cached == current) {
+    cache.hits++;
+    result->setError(SWIFT_OK);
+    result->setPayload(listing);
+    return result;
+  }
+
+  /**
+   * Try names added after the last cached one: if they account for the
+   * whole change in count and bytes, nothing else moved.
+   */
+  SwiftError error = SWIFT_OK;
+  bool refreshed = false;
+  if (haveCache && !listing->empty()
+      && current.objectCount > cached.objectCount) {
+    size_t last = listing->size() - 1;
+    string lastName(listing->getName(last), listing->getNameLength(last));
+    uint64_t added, addedBytes;
+    error = listAfter(_container, lastName, _newest, *listing, added,
+        addedBytes);
+    refreshed = error.code == SWIFT_OK.code && added > 0
+        && cached.objectCount + (int64_t) added == current.objectCount
+        && cached.bytesUsed + (int64_t) addedBytes == current.bytesUsed;
+    if (refreshed)
+      cache.incremental++;
+  }
+
+  if (!refreshed) {
+    cache.misses++;
+    delete listing;
+    listing = new ObjectListing(&_container);
+    uint64_t added, addedBytes;
+    error = listAfter(_container, "", _newest, *listing, added, addedBytes);
+    if (error.code != SWIFT_OK.code) {
+      delete listing;
+      result->setError(error);
+      return result;
+    }
+  }
+
+  listing->shrinkToFit();
+  if (!directory.empty())
+    writeCacheFile(path, current, *listing);
+  result->setError(SWIFT_OK);
+  result->setPayload(listing);
+  return result;
+}
+
+void ListingCache::invalidate(Container &_container) {
+  string directory = getDirectory();
+  if (!directory.empty())
+    unlink(cacheFileOf(_container, directory).c_str());
+}
+
+uint64_t ListingCache::getHits() {
+  return cache.hits;
+}
+
+uint64_t ListingCache::getIncrementalRefreshes() {
+  return cache.incremental;
+}
+
+uint64_t ListingCache::getMisses() {
+  return cache.misses;
+}
+
+} /* namespace Swift */
@@ -0,0 +1,93 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef LISTINGCACHE_H_
+#define LISTINGCACHE_H_
+
+#include "ObjectListing.h"
+#include "swiftcpp_export.h"
+
+#include <cstdint>
+#include <string>
+
+namespace Swift {
+
+/**
+ * Optional on-disk cache of container listings, one file per
+ * account/container in a directory of the caller's choice. Each file holds
+ * the container's X-Container-Object-Count, X-Container-Bytes-Used and
+ * Last-Modified next to its ObjectListing, and is read back with mmap().
+ *
+ * getListing() HEADs the container: if its object count and bytes used
+ * did not change the cached listing is returned without listing anything.
+ * If only names sorting after the last cached one were added (the usual
+ * case for time stamped names), only those are listed. Any other change of
+ * count or bytes relists the whole container.
+ *
+ * The container's Last-Modified follows its own PUT/POST only, not the
+ * writes of its objects. An overwrite which keeps count and bytes (same
+ * size content, or a delete and a create of equal size) is not detected:
+ * the cached hash and last_modified of that object stay stale until count
+ * or bytes change. Call invalidate() after such writes when they matter.
+ *
+ * Disabled until setDirectory() is called; Container::swiftGetObjectListing
+ * uses it for unprefixed listings once enabled.
+ */
+class SWIFTCPP_EXPORT ListingCache {
+private:
+  ListingCache() {}
+  ~ListingCache() {}
+
+public:
+  /**
+   * Directory of the cache files, which must exist; "" disables the cache.
+   */
+  static void setDirectory(const std::string &_directory);
+  static std::string getDirectory();
+  static bool isEnabled();
+
+  /**
+   * Listing of all objects of _container, from the cache when possible.
+   */
+  static SwiftResult<ObjectListing*>* getListing(Container &_container,
+      bool _newest = false);
+
+  /**
+   * Drops the cached listing of _container
+   */
+  static void invalidate(Container &_container);
+
+  /**
+   * Listings served without listing anything
+   */
+  static uint64_t getHits();
+
+  /**
+   * Listings refreshed by listing only the names added at the end
+   */
+  static uint64_t getIncrementalRefreshes();
+
+  /**
+   * Listings fetched in full
+   */
+  static uint64_t getMisses();
+};
+
+} /* namespace Swift */
+#endif /* LISTINGCACHE_H_ */
@@ -0,0 +1,348 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ListingParser.h"
+
+using namespace std;
+
+namespace Swift {
+
+void ListingEntry::clear() {
+  //clear() keeps the capacity, so strings stop allocating after a while
+  name.clear();
+  bytes = 0;
+  count = 0;
+  hash.clear();
+  contentType.clear();
+  lastModified.clear();
+  subdir.clear();
+  sloEtag.clear();
+}
+
+/**
+ * Recursive descent over a streambuf; every read goes through the inline
+ * fast path of sgetc()/sbumpc() while the buffer holds data.
+ */
+class ListingScanner {
+  streambuf *input;
+  string key;
+  string scratch;
+
+public:
+  string error;
+
+  ListingScanner(streambuf *_input) :
+      input(_input) {
+  }
+
+  int peek() {
+    return input->sgetc();
+  }
+
+  void skipSpace() {
+    int c = input->sgetc();
+    while (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+      c = input->snextc();
+  }
+
+  bool fail(const string &_what) {
+    if (error.empty())
+      error = _what;
+    return false;
+  }
+
+  bool expect(char _c) {
+    skipSpace();
+    if (input->sgetc() != _c)
+      return fail(string("Expected '") + _c + "'");
+    input->sbumpc();
+    return true;
+  }
+
+  static void appendUTF8(string &_out, uint32_t _code) {
+    if (_code < 0x80)
+      _out += (char) _code;
+    else if (_code < 0x800) {
+      _out += (char) (0xC0 | (_code >> 6));
+      _out += (char) (0x80 | (_code & 0x3F));
+    } else if (_code < 0x10000) {
+      _out += (char) (0xE0 | (_code >> 12));
+      _out += (char) (0x80 | ((_code >> 6) & 0x3F));
+      _out += (char) (0x80 | (_code & 0x3F));
+    } else {
+      _out += (char) (0xF0 | (_code >> 18));
+      _out += (char) (0x80 | ((_code >> 12) & 0x3F));
+      _out += (char) (0x80 | ((_code >> 6) & 0x3F));
+      _out += (char) (0x80 | (_code & 0x3F));
+    }
+  }
+
+  bool readHex4(uint32_t &_code) {
+    _code = 0;
+    for (int i = 0; i < 4; i++) {
+      int c = input->sbumpc();
+      _code <<= 4;
+      if (c >= '0' && c <= '9')
+        _code |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        _code |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        _code |= c - 'A' + 10;
+      else
+        return fail("Invalid \\u escape");
+    }
+    return true;
+  }
+
+  /**
+   * Reads a string (opening quote already checked) into _out
+   */
+  bool readString(string &_out) {
+    _out.clear();
+    input->sbumpc();
+    while (true) {
+      int c = input->sbumpc();
+      if (c == '"')
+        return true;
+      if (c == char_traits<char>::eof())
+        return fail("Unterminated string");
+      if (c != '\\') {
+        _out += (char) c;
+        continue;
+      }
+      c = input->sbumpc();
+      switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        _out += (char) c;
+        break;
+      case 'b':
+        _out += '\b';
+        break;
+      case 'f':
+        _out += '\f';
+        break;
+      case 'n':
+        _out += '\n';
+        break;
+      case 'r':
+        _out += '\r';
+        break;
+      case 't':
+        _out += '\t';
+        break;
+      case 'u': {
+        uint32_t code;
+        if (!readHex4(code))
+          return false;
+        //Characters outside the BMP come as a surrogate pair
+        if (code >= 0xD800 && code < 0xDC00) {
+          uint32_t low;
+          if (input->sbumpc() != '\\' || input->sbumpc() != 'u'
+              || !readHex4(low) || low < 0xDC00 || low > 0xDFFF)
+            return fail("Invalid surrogate pair");
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        appendUTF8(_out, code);
+        break;
+      }
+      default:
+        return fail("Invalid escape");
+      }
+    }
+  }
+
+  /**
+   * Reads a number, or a string holding one, keeping its integer part
+   */
+  bool readUnsigned(uint64_t &_out) {
+    _out = 0;
+    int c = input->sgetc();
+    if (c == '"') {
+      if (!readString(scratch))
+        return false;
+      for (char digit : scratch) {
+        if (digit < '0' || digit > '9')
+          break;
+        _out = _out * 10 + (digit - '0');
+      }
+      return true;
+    }
+    if (c == 'n')
+      return skipLiteral("null");
+    if (c == '-')
+      c = input->snextc();
+    if (c < '0' || c > '9')
+      return fail("Expected a number");
+    while (c >= '0' && c <= '9') {
+      _out = _out * 10 + (c - '0');
+      c = input->snextc();
+    }
+    //Fraction and exponent are never used by Swift for these fields
+    while (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-'
+        || (c >= '0' && c <= '9'))
+      c = input->snextc();
+    return true;
+  }
+
+  bool readStringField(string &_out) {
+    int c = input->sgetc();
+    if (c == '"')
+      return readString(_out);
+    return skipValue();
+  }
+
+  bool skipLiteral(const char *_literal) {
+    for (const char *p = _literal; *p != '\0'; p++)
+      if (input->sbumpc() != *p)
+        return fail(string("Expected ") + _literal);
+    return true;
+  }
+
+  /**
+   * Skips any JSON value, e.g. the value of a key we do not know
+   */
+  bool skipValue() {
+    skipSpace();
+    int c = input->sgetc();
+    switch (c) {
+    case '"':
+      return readString(scratch);
+    case '{':
+    case '[': {
+      char close = c == '{' ? '}' : ']';
+      input->sbumpc();
+      skipSpace();
+      if (input->sgetc() == close) {
+        input->sbumpc();
+        return true;
+      }
+      while (true) {
+        if (c == '{') {
+          skipSpace();
+          if (input->sgetc() != '"')
+            return fail("Expected a key");
+          if (!readString(scratch) || !expect(':'))
+            return false;
+        }
+        if (!skipValue())
+          return false;
+        skipSpace();
+        int next = input->sbumpc();
+        if (next == close)
+          return true;
+        if (next != ',')
+          return fail(string("Expected ',' or '") + close + "'");
+      }
+    }
+    case 't':
+      return skipLiteral("true");
+    case 'f':
+      return skipLiteral("false");
+    case 'n':
+      return skipLiteral("null");
+    default:
+      uint64_t ignored;
+      return readUnsigned(ignored);
+    }
+  }
+
+  bool readEntry(ListingEntry &_entry) {
+    _entry.clear();
+    if (!expect('{'))
+      return false;
+    skipSpace();
+    if (input->sgetc() == '}') {
+      input->sbumpc();
+      return true;
+    }
+    while (true) {
+      skipSpace();
+      if (input->sgetc() != '"')
+        return fail("Expected a key");
+      if (!readString(key) || !expect(':'))
+        return false;
+      skipSpace();
+      bool ok;
+      if (key == "name")
+        ok = readStringField(_entry.name);
+      else if (key == "bytes")
+        ok = readUnsigned(_entry.bytes);
+      else if (key == "count")
+        ok = readUnsigned(_entry.count);
+      else if (key == "hash")
+        ok = readStringField(_entry.hash);
+      else if (key == "content_type")
+        ok = readStringField(_entry.contentType);
+      else if (key == "last_modified")
+        ok = readStringField(_entry.lastModified);
+      else if (key == "subdir")
+        ok = readStringField(_entry.subdir);
+      else if (key == "slo_etag")
+        ok = readStringField(_entry.sloEtag);
+      else
+        ok = skipValue();
+      if (!ok)
+        return false;
+      skipSpace();
+      int next = input->sbumpc();
+      if (next == '}')
+        return true;
+      if (next != ',')
+        return fail("Expected ',' or '}'");
+    }
+  }
+};
+
+bool ListingParser::parse(std::istream &_input,
+    const ListingCallback &_callback, std::string &_error) {
+  ListingScanner scanner(_input.rdbuf());
+  ListingEntry entry;
+  _error.clear();
+
+  //An empty body is an empty listing
+  scanner.skipSpace();
+  if (scanner.peek() == char_traits<char>::eof())
+    return true;
+  if (!scanner.expect('[')) {
+    _error = scanner.error;
+    return false;
+  }
+  scanner.skipSpace();
+  if (scanner.peek() == ']')
+    return true;
+  while (true) {
+    if (!scanner.readEntry(entry)) {
+      _error = scanner.error;
+      return false;
+    }
+    if (!_callback(entry))
+      return true;
+    if (!scanner.expect(',')) {
+      scanner.error.clear();
+      if (scanner.peek() == ']')
+        return true;
+      _error = "Expected ',' or ']'";
+      return false;
+    }
+  }
+}
+
+} /* namespace Swift */
@@ -0,0 +1,89 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef LISTINGPARSER_H_
+#define LISTINGPARSER_H_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * One entry of a JSON container (objects) or account (containers)
+ * listing. Fields missing from an entry are empty or zero.
+ */
+struct SWIFTCPP_EXPORT ListingEntry {
+  std::string name;
+  /**
+   * Object size, or bytes used by a container
+   */
+  uint64_t bytes = 0;
+  /**
+   * Number of objects in a container
+   */
+  uint64_t count = 0;
+  std::string hash;
+  std::string contentType;
+  std::string lastModified;
+  /**
+   * Pseudo directory returned instead of objects when listing with a
+   * delimiter; name is empty for such entries.
+   */
+  std::string subdir;
+  /**
+   * Set for Static Large Object manifests (Swift 2.16 and later)
+   */
+  std::string sloEtag;
+
+  void clear();
+};
+
+/**
+ * Receives each entry as soon as it is parsed. The entry is reused for the
+ * next one, so copy what must be kept. Return false to stop parsing.
+ */
+typedef std::function<bool(const ListingEntry &_entry)> ListingCallback;
+
+/**
+ * Streaming parser for Swift's JSON listings ([{"name":...,...},...]).
+ * It reads straight from the stream buffer and builds no document tree;
+ * unknown keys are skipped, so newer Swift releases parse fine.
+ */
+class SWIFTCPP_EXPORT ListingParser {
+private:
+  ListingParser() {}
+  ~ListingParser() {}
+
+public:
+  /**
+   * Parses the whole listing in _input, calling _callback per entry.
+   * @return
+   *  false on malformed input, with the reason in _error; stopping from
+   *  the callback is not an error.
+   */
+  static bool parse(std::istream &_input, const ListingCallback &_callback,
+      std::string &_error);
+};
+
+} /* namespace Swift */
+#endif /* LISTINGPARSER_H_ */
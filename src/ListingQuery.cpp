@@ -0,0 +1,122 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ListingQuery.h"
+#include "HTTPIO.h"
+
+using namespace std;
+
+namespace Swift {
+
+ListingQuery::ListingQuery() :
+    formatValue("json"), limitValue(0), reverseValue(false) {
+}
+
+ListingQuery& ListingQuery::format(const std::string &_format) {
+  formatValue = _format;
+  return *this;
+}
+
+ListingQuery& ListingQuery::prefix(const std::string &_prefix) {
+  prefixValue = _prefix;
+  return *this;
+}
+
+ListingQuery& ListingQuery::delimiter(char _delimiter) {
+  delimiterValue = string(1, _delimiter);
+  return *this;
+}
+
+ListingQuery& ListingQuery::marker(const std::string &_marker) {
+  markerValue = _marker;
+  return *this;
+}
+
+ListingQuery& ListingQuery::endMarker(const std::string &_endMarker) {
+  endMarkerValue = _endMarker;
+  return *this;
+}
+
+ListingQuery& ListingQuery::path(const std::string &_path) {
+  pathValue = _path;
+  return *this;
+}
+
+ListingQuery& ListingQuery::limit(uint32_t _limit) {
+  limitValue = _limit;
+  return *this;
+}
+
+ListingQuery& ListingQuery::reverse(bool _reverse) {
+  reverseValue = _reverse;
+  return *this;
+}
+
+const std::string& ListingQuery::getFormat() const {
+  return formatValue;
+}
+
+const std::string& ListingQuery::getPrefix() const {
+  return prefixValue;
+}
+
+const std::string& ListingQuery::getDelimiter() const {
+  return delimiterValue;
+}
+
+const std::string& ListingQuery::getMarker() const {
+  return markerValue;
+}
+
+const std::string& ListingQuery::getEndMarker() const {
+  return endMarkerValue;
+}
+
+uint32_t ListingQuery::getLimit() const {
+  return limitValue;
+}
+
+std::vector<HTTPHeader> ListingQuery::toParams() const {
+  vector<HTTPHeader> params;
+  //plain is what Swift returns without a format parameter
+  if (!formatValue.empty() && formatValue != "plain")
+    params.push_back(HTTPHeader("format", formatValue));
+  if (!prefixValue.empty())
+    params.push_back(HTTPHeader("prefix", prefixValue));
+  if (!delimiterValue.empty())
+    params.push_back(HTTPHeader("delimiter", delimiterValue));
+  if (!markerValue.empty())
+    params.push_back(HTTPHeader("marker", markerValue));
+  if (!endMarkerValue.empty())
+    params.push_back(HTTPHeader("end_marker", endMarkerValue));
+  if (!pathValue.empty())
+    params.push_back(HTTPHeader("path", pathValue));
+  if (limitValue > 0)
+    params.push_back(HTTPHeader("limit", to_string(limitValue)));
+  if (reverseValue)
+    params.push_back(HTTPHeader("reverse", "true"));
+  return params;
+}
+
+std::string ListingQuery::toString() const {
+  vector<HTTPHeader> params = toParams();
+  return buildQuery(&params);
+}
+
+} /* namespace Swift */
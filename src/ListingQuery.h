@@ -0,0 +1,118 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef LISTINGQUERY_H_
+#define LISTINGQUERY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Header.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Query parameters of a container or account listing. Filtering is done
+ * by the proxy, so only the wanted entries are transferred; values are
+ * percent-encoded when the request is built.
+ *
+ * Example:
+ * container.swiftListObjects(ListingQuery().prefix("logs/2014/")
+ *     .delimiter('/').limit(1000));
+ */
+class SWIFTCPP_EXPORT ListingQuery {
+private:
+  std::string formatValue;
+  std::string prefixValue;
+  std::string delimiterValue;
+  std::string markerValue;
+  std::string endMarkerValue;
+  std::string pathValue;
+  uint32_t limitValue;
+  bool reverseValue;
+
+public:
+  /**
+   * A json listing of everything
+   */
+  ListingQuery();
+
+  /**
+   * json (default), xml or plain (one name per line)
+   */
+  ListingQuery& format(const std::string &_format);
+
+  /**
+   * Only names starting with _prefix
+   */
+  ListingQuery& prefix(const std::string &_prefix);
+
+  /**
+   * Names holding _delimiter after the prefix are rolled up into one
+   * subdir entry, like directories.
+   */
+  ListingQuery& delimiter(char _delimiter);
+
+  /**
+   * Only names sorting after _marker
+   */
+  ListingQuery& marker(const std::string &_marker);
+
+  /**
+   * Only names sorting before _endMarker
+   */
+  ListingQuery& endMarker(const std::string &_endMarker);
+
+  /**
+   * Objects in the pseudo directory _path (container listings only)
+   */
+  ListingQuery& path(const std::string &_path);
+
+  /**
+   * At most _limit entries; Swift returns at most 10000. 0 leaves the
+   * server default.
+   */
+  ListingQuery& limit(uint32_t _limit);
+
+  /**
+   * Names in descending order (Swift 2.4 and later)
+   */
+  ListingQuery& reverse(bool _reverse = true);
+
+  const std::string& getFormat() const;
+  const std::string& getPrefix() const;
+  const std::string& getDelimiter() const;
+  const std::string& getMarker() const;
+  const std::string& getEndMarker() const;
+  uint32_t getLimit() const;
+
+  /**
+   * The parameters which are set, as doSwiftTransaction uriParams
+   */
+  std::vector<HTTPHeader> toParams() const;
+
+  /**
+   * Encoded query string, e.g. format=json&prefix=a%2Fb
+   */
+  std::string toString() const;
+};
+
+} /* namespace Swift */
+#endif /* LISTINGQUERY_H_ */
@@ -0,0 +1,175 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "MetadataSession.h"
+#include "Container.h"
+#include "HTTPIO.h"
+#include <strings.h>
+#include <cstring>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+static const string OBJECT_META_PREFIX = "X-Object-Meta-";
+
+bool MetadataSession::CaseInsensitiveLess::operator()(const string &_a,
+    const string &_b) const {
+  return strcasecmp(_a.c_str(), _b.c_str()) < 0;
+}
+
+MetadataSession::MetadataSession(const Object &_object,
+    chrono::milliseconds _ttl) :
+    object(_object), ttl(_ttl), loaded(false) {
+}
+
+MetadataSession& MetadataSession::set(const string &_key,
+    const string &_value) {
+  pendingRemove.erase(_key);
+  pendingSet[_key] = _value;
+  return *this;
+}
+
+MetadataSession& MetadataSession::remove(const string &_key) {
+  pendingSet.erase(_key);
+  pendingRemove.insert(_key);
+  return *this;
+}
+
+SwiftResult<int*>* MetadataSession::refresh() {
+  //The merged metadata are posted back: never start from a cached HEAD
+  SwiftResult<int*> *head = object.swiftShowMetadata(nullptr, false, true);
+  if (head->getError().code != SWIFT_OK.code
+      || head->getResponse() == nullptr) {
+    invalidate();
+    return head;
+  }
+
+  known.clear();
+  HTTPResponse *response = head->getResponse();
+  for (NameValueCollection::ConstIterator it = response->begin();
+      it != response->end(); ++it)
+    if (it->first.size() > OBJECT_META_PREFIX.size()
+        && strncasecmp(it->first.c_str(), OBJECT_META_PREFIX.c_str(),
+            OBJECT_META_PREFIX.size()) == 0)
+      known[it->first.substr(OBJECT_META_PREFIX.size())] = it->second;
+  etag = response->get("Etag", "");
+  loaded = true;
+  loadedAt = chrono::steady_clock::now();
+  return head;
+}
+
+SwiftResult<istream*>* MetadataSession::commit() {
+  if (!hasPendingChanges()) {
+    SwiftResult<istream*> *result = new SwiftResult<istream*>();
+    result->setError(SWIFT_OK);
+    result->setPayload(nullptr);
+    return result;
+  }
+
+  if (!isFresh()) {
+    SwiftResult<int*> *head = refresh();
+    SwiftError error = head->getError();
+    delete head;
+    if (error.code != SWIFT_OK.code) {
+      SwiftResult<istream*> *result = new SwiftResult<istream*>();
+      result->setError(error);
+      result->setPayload(nullptr);
+      return result;
+    }
+  }
+
+  MetadataMap merged = known;
+  for (const string &key : pendingRemove)
+    merged.erase(key);
+  for (MetadataMap::const_iterator it = pendingSet.begin();
+      it != pendingSet.end(); ++it)
+    merged[it->first] = it->second;
+
+  //A POST replaces all metadata, so all of it is sent
+  vector<HTTPHeader> reqMap;
+  for (MetadataMap::const_iterator it = merged.begin(); it != merged.end();
+      ++it)
+    reqMap.push_back(HTTPHeader(OBJECT_META_PREFIX + it->first, it->second));
+
+  /**
+   * Check HTTP return code
+   * 202:
+   *  Success. HTTP_ACCEPTED
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_ACCEPTED);
+
+  if (object.getContainer() == nullptr)
+    return returnNullError<istream*>("container");
+  string path = object.getContainer()->getName() + "/" + object.getName();
+  SwiftResult<istream*> *result = doSwiftTransaction<istream*>(
+      object.getContainer()->getAccount(), path, HTTPRequest::HTTP_POST,
+      nullptr, &reqMap, &validHTTPCodes);
+  if (result->getError().code == SWIFT_OK.code) {
+    //The object now holds exactly what was sent
+    known.swap(merged);
+    loadedAt = chrono::steady_clock::now();
+    pendingSet.clear();
+    pendingRemove.clear();
+  } else
+    invalidate();
+  return result;
+}
+
+void MetadataSession::invalidate() {
+  loaded = false;
+  known.clear();
+  etag.clear();
+}
+
+bool MetadataSession::isFresh() const {
+  return loaded && chrono::steady_clock::now() - loadedAt < ttl;
+}
+
+map<string, string> MetadataSession::getMetadata() {
+  if (!isFresh())
+    delete refresh();
+  map<string, string> metadata;
+  for (MetadataMap::const_iterator it = known.begin(); it != known.end();
+      ++it)
+    if (pendingRemove.find(it->first) == pendingRemove.end()
+        && pendingSet.find(it->first) == pendingSet.end())
+      metadata[it->first] = it->second;
+  for (MetadataMap::const_iterator it = pendingSet.begin();
+      it != pendingSet.end(); ++it)
+    metadata[it->first] = it->second;
+  return metadata;
+}
+
+const string& MetadataSession::getETag() const {
+  return etag;
+}
+
+bool MetadataSession::hasPendingChanges() const {
+  return !pendingSet.empty() || !pendingRemove.empty();
+}
+
+Object& MetadataSession::getObject() {
+  return object;
+}
+
+} /* namespace Swift */
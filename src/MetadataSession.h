@@ -0,0 +1,127 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef METADATASESSION_H_
+#define METADATASESSION_H_
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include "Object.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Keeps the metadata and ETag of one object so updates need no HEAD
+ * each. A POST replaces all metadata of an object, so changes are merged
+ * into the known metadata and sent in full; set() and remove() calls pile
+ * up until commit() sends them in a single POST. The known metadata is
+ * read again (HEAD) only when it is older than the TTL.
+ * A session is meant to be used by one thread at a time.
+ *
+ * Example:
+ * MetadataSession tags(object);
+ * tags.set("Color", "red").set("Size", "XL").remove("Draft");
+ * delete tags.commit();
+ */
+class SWIFTCPP_EXPORT MetadataSession {
+private:
+  struct CaseInsensitiveLess {
+    bool operator()(const std::string &_a, const std::string &_b) const;
+  };
+  typedef std::map<std::string, std::string, CaseInsensitiveLess> MetadataMap;
+
+  Object object;
+  std::chrono::milliseconds ttl;
+
+  /**
+   * Metadata and ETag as of the last HEAD or successful POST
+   */
+  MetadataMap known;
+  std::string etag;
+  bool loaded;
+  std::chrono::steady_clock::time_point loadedAt;
+
+  /**
+   * Changes not sent yet
+   */
+  MetadataMap pendingSet;
+  std::set<std::string, CaseInsensitiveLess> pendingRemove;
+
+public:
+  /**
+   * _ttl
+   *  How long the known metadata is trusted. Changes made by others in
+   *  the meantime are overwritten by commit().
+   */
+  MetadataSession(const Object &_object,
+      std::chrono::milliseconds _ttl = std::chrono::milliseconds(30000));
+
+  /**
+   * Queues a new value for a key
+   */
+  MetadataSession& set(const std::string &_key, const std::string &_value);
+
+  /**
+   * Queues the removal of a key
+   */
+  MetadataSession& remove(const std::string &_key);
+
+  /**
+   * Sends the queued changes in one POST, after a HEAD only if the known
+   * metadata is missing or expired. Nothing is sent without changes.
+   * @return
+   *  The POST result. Queued changes are kept if it failed.
+   */
+  SwiftResult<std::istream*>* commit();
+
+  /**
+   * HEADs the object and replaces the known metadata and ETag.
+   */
+  SwiftResult<int*>* refresh();
+
+  /**
+   * Forgets the known metadata; the next commit() starts with a HEAD.
+   */
+  void invalidate();
+
+  /**
+   * Whether the known metadata is there and younger than the TTL
+   */
+  bool isFresh() const;
+
+  /**
+   * Known metadata with the queued changes applied, refreshed first if it
+   * is not fresh.
+   */
+  std::map<std::string, std::string> getMetadata();
+
+  /**
+   * ETag of the object as of the last HEAD
+   */
+  const std::string& getETag() const;
+
+  bool hasPendingChanges() const;
+  Object& getObject();
+};
+
+} /* namespace Swift */
+#endif /* METADATASESSION_H_ */
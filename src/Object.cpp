@@ -19,8 +19,23 @@
 
 #include "Object.h"
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <iomanip>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "HTTPIO.h"
+#include "ContentCache.h"
+#include "Executor.h"
+#include "json.h"
 #include <Poco/MD5Engine.h>
+#include <Poco/Timestamp.h>
 
 using namespace std;
 using namespace Poco;
@@ -52,9 +67,18 @@ SwiftResult<istream*>* Object::swiftGetObjectContent(
   /**
    * Valid HTTP return codes for this operation: 200
    * Success. The response body shows object content
+   *
+   * 206:
+   *  Success. The response body shows the requested Range.
    */
   vector<int> validHTTPCodes;
   validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_PARTIAL_CONTENT);
+
+  //Plain reads go through the content cache when it is on
+  if ((_uriParams == nullptr || _uriParams->empty())
+      && (_reqMap == nullptr || _reqMap->empty()) && ContentCache::isEnabled())
+    return ContentCache::getContent(*this);
 
   //Do swift transaction
   return doSwiftTransaction<istream*>(container->getAccount(), path,
@@ -62,8 +86,30 @@ SwiftResult<istream*>* Object::swiftGetObjectContent(
       nullptr);
 }
 
+SwiftResult<istream*>* Object::swiftGetObjectContent(
+    const Preconditions &_preconditions, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<istream*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  //Same codes as above plus 304 and 412
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_PARTIAL_CONTENT);
+  vector<HTTPHeader> reqMap;
+  if (_reqMap != nullptr)
+    reqMap = *_reqMap;
+  _preconditions.apply(reqMap, validHTTPCodes);
+
+  return doSwiftTransaction<istream*>(container->getAccount(), path,
+      HTTPRequest::HTTP_GET, _uriParams, &reqMap, &validHTTPCodes, nullptr, 0,
+      nullptr);
+}
+
 SwiftResult<int*>* Object::swiftCreateReplaceObject(const char* _data,
-    uint32_t _size, bool _calculateETag, std::vector<HTTPHeader>* _uriParams,
+    uint64_t _size, bool _calculateETag, std::vector<HTTPHeader>* _uriParams,
     std::vector<HTTPHeader>* _reqMap) {
   //Check Container
   if (container == nullptr)
@@ -83,32 +129,67 @@ SwiftResult<int*>* Object::swiftCreateReplaceObject(const char* _data,
   vector<int> validHTTPCodes;
   validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
 
-  //Calculate ETag if requested
-  bool shouldDelete = false;
-  if (_calculateETag) {
-    MD5Engine md5;
-    md5.reset();
-    md5.update(_data, _size);
-    string digestString(DigestEngine::digestToHex(md5.digest()));
-    //Set Header
-    if (_reqMap == nullptr) {
-      _reqMap = new vector<HTTPHeader>();
-      shouldDelete = true;
-    }
-    HTTPHeader etagHeader("ETag", digestString);
-    _reqMap->push_back(etagHeader);
-  }
+  //Do swift transaction; the ETag is computed while the data is sent
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, _uriParams, _reqMap, &validHTTPCodes, _data,
+      _size, nullptr, _calculateETag);
+}
 
-  //Do swift transaction
-  SwiftResult<int*>* result = doSwiftTransaction<int*>(
-      container->getAccount(), path, HTTPRequest::HTTP_PUT, _uriParams, _reqMap,
-      &validHTTPCodes, _data, _size, nullptr);
-  if (!shouldDelete)
-    return result;
-  else {
-    delete _reqMap;
-    return result;
-  }
+SwiftResult<int*>* Object::swiftCreateReplaceObject(BodySource &_body,
+    bool _calculateETag, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  //Same codes as the buffered version
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, _uriParams, _reqMap, &validHTTPCodes, _body,
+      nullptr, _calculateETag);
+}
+
+SwiftResult<int*>* Object::swiftCreateReplaceObject(const char* _data,
+    uint64_t _size, const Preconditions &_preconditions, bool _calculateETag,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+  vector<HTTPHeader> reqMap;
+  if (_reqMap != nullptr)
+    reqMap = *_reqMap;
+  _preconditions.apply(reqMap, validHTTPCodes);
+
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, _uriParams, &reqMap, &validHTTPCodes, _data,
+      _size, nullptr, _calculateETag);
+}
+
+SwiftResult<int*>* Object::swiftCreateReplaceObject(BodySource &_body,
+    const Preconditions &_preconditions, bool _calculateETag,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+  vector<HTTPHeader> reqMap;
+  if (_reqMap != nullptr)
+    reqMap = *_reqMap;
+  _preconditions.apply(reqMap, validHTTPCodes);
+
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, _uriParams, &reqMap, &validHTTPCodes, _body,
+      nullptr, _calculateETag);
 }
 
 SwiftResult<int*>* Object::swiftCopyObject(const std::string& _dstObjectName,
@@ -267,7 +348,8 @@ SwiftResult<istream*>* Object::swiftDeleteMetadata(
 }
 
 SwiftResult<HTTPClientSession*>* Object::swiftCreateReplaceObject(std::ostream* &outputStream,
-    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap,
+    bool _calculateETag) {
   //Check Container
   if (container == nullptr)
     return returnNullError<HTTPClientSession*>("container");
@@ -282,7 +364,7 @@ SwiftResult<HTTPClientSession*>* Object::swiftCreateReplaceObject(std::ostream*
   //Create parameter map
   vector<HTTPHeader> reqParamMap;
   //Add authentication token
-  string tokenID = container->getAccount()->getToken()->getId();
+  string tokenID = container->getAccount()->getTokenID();
   HTTPHeader authHeader("X-Auth-Token", tokenID);
   reqParamMap.push_back(authHeader);
   //Push Chuncked Encoding
@@ -303,23 +385,26 @@ SwiftResult<HTTPClientSession*>* Object::swiftCreateReplaceObject(std::ostream*
   path = encoded;
   uri.setPath(uri.getPath() + "/" + path);
 
-  if (_uriParams != nullptr && _uriParams->size() > 0) {
-    //Create appropriate URI
-    ostringstream queryStream;
-    for (unsigned int i = 0; i < _uriParams->size(); i++) {
-      if (i > 0)
-        queryStream << ",";
-      queryStream << _uriParams->at(i).getQueryValue();
-    }
-    uri.setQuery(queryStream.str());
-    //cout << uri.toString() << endl;
-  }
+  if (_uriParams != nullptr && _uriParams->size() > 0)
+    uri.setRawQuery(buildQuery(_uriParams));
 
   //Creating HTTP Session
   HTTPClientSession *httpSession = nullptr;
   try {
     /** This operation does not accept a request body. **/
-    httpSession = doHTTPIO(uri, HTTPRequest::HTTP_PUT, &reqParamMap, outputStream);
+    httpSession = doHTTPIO(uri, HTTPRequest::HTTP_PUT, &reqParamMap,
+        outputStream, _calculateETag);
+    //The object changes once the caller completed the upload and received
+    //the response
+    shared_ptr<StatCache> statCache = container->getAccount()->getStatCache();
+    PooledHTTPClientSession *pooled =
+        dynamic_cast<PooledHTTPClientSession*>(httpSession);
+    if (statCache && pooled != nullptr) {
+      string statPath = container->getName() + "/" + name;
+      pooled->onResponse([statCache, statPath](const HTTPResponse&) {
+        statCache->invalidate(statPath);
+      });
+    }
     //Now we should increase number of calls to SWIFT API
     container->getAccount()->increaseCallCounter();
   } catch (Exception &e) {
@@ -343,7 +428,7 @@ SwiftResult<HTTPClientSession*>* Object::swiftCreateReplaceObject(std::ostream*
 }
 
 SwiftResult<int*>* Object::swiftShowMetadata(
-    std::vector<HTTPHeader>* _uriParams, bool _newest) {
+    std::vector<HTTPHeader>* _uriParams, bool _newest, bool _bypassStatCache) {
   //Check Container
   if (container == nullptr)
     return returnNullError<int*>("container");
@@ -376,14 +461,91 @@ SwiftResult<int*>* Object::swiftShowMetadata(
   if (_newest)
     reqHeaders.push_back(*new HTTPHeader("X-Newest", "True"));
 
+  //Answer from the stat cache if there is one
+  shared_ptr<StatCache> statCache;
+  if (container->getAccount() != nullptr && !_newest
+      && (_uriParams == nullptr || _uriParams->empty()))
+    statCache = container->getAccount()->getStatCache();
+  ObjectStat stat;
+  if (statCache && !_bypassStatCache && statCache->lookup(path, stat)) {
+    SwiftResult<int*> *result = new SwiftResult<int*>();
+    HTTPResponse *response = new HTTPResponse();
+    stat.toResponse(*response);
+    result->setResponse(response);
+    result->setPayload(nullptr);
+    if (stat.exists)
+      result->setError(SWIFT_OK);
+    else
+      result->setError(SwiftError(SwiftError::SWIFT_HTTP_ERROR,
+          "Code:404\tReason:" + response->getReason()));
+    return result;
+  }
+  uint64_t generation = statCache ? statCache->getGeneration(path) : 0;
+
   //Do swift transaction
+  SwiftResult<int*> *result = doSwiftTransaction<int*>(container->getAccount(),
+      path, HTTPRequest::HTTP_HEAD, _uriParams, &reqHeaders, &validHTTPCodes,
+      nullptr, 0, nullptr);
+  if (statCache && result->getResponse() != nullptr) {
+    if (result->getError().code == SWIFT_OK.code)
+      statCache->storeFound(path, *result->getResponse(), generation);
+    else if (result->getResponse()->getStatus()
+        == HTTPResponse::HTTP_NOT_FOUND)
+      statCache->storeMissing(path, generation);
+  }
+  return result;
+}
+
+SwiftResult<int*>* Object::swiftShowMetadata(
+    const Preconditions &_preconditions, bool _newest) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  //Same codes as above plus 304 and 412
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_ACCEPTED);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_NO_CONTENT);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_RESET_CONTENT);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_PARTIAL_CONTENT);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_NONAUTHORITATIVE);
+
+  vector<HTTPHeader> reqHeaders;
+  if (_newest)
+    reqHeaders.push_back(HTTPHeader("X-Newest", "True"));
+  _preconditions.apply(reqHeaders, validHTTPCodes);
+
+  //Never from the stat cache, the server has to evaluate the condition
   return doSwiftTransaction<int*>(container->getAccount(), path,
-      HTTPRequest::HTTP_HEAD, _uriParams, &reqHeaders, &validHTTPCodes, nullptr,
+      HTTPRequest::HTTP_HEAD, nullptr, &reqHeaders, &validHTTPCodes, nullptr,
       0, nullptr);
 }
 
+SwiftResult<ObjectStat*>* Object::swiftStat(bool _newest) {
+  SwiftResult<int*> *head = swiftShowMetadata(nullptr, _newest);
+  SwiftResult<ObjectStat*> *result = new SwiftResult<ObjectStat*>();
+  result->setError(head->getError());
+  result->setPayload(nullptr);
+  if (head->getResponse() != nullptr) {
+    ObjectStat *stat = new ObjectStat();
+    if (head->getError().code == SWIFT_OK.code)
+      stat->parse(*head->getResponse());
+    else if (head->getResponse()->getStatus() != HTTPResponse::HTTP_NOT_FOUND) {
+      delete stat;
+      stat = nullptr;
+    }
+    result->setPayload(stat);
+  }
+  delete head;
+  return result;
+}
+
 std::vector<std::pair<std::string, std::string> >* Object::getExistingMetaData() {
-  SwiftResult<int*>* metadata = this->swiftShowMetadata(nullptr, false);
+  //Written back by the caller: a cached answer could erase newer keys
+  SwiftResult<int*>* metadata = this->swiftShowMetadata(nullptr, false, true);
   if (metadata == nullptr){
     delete metadata;
     metadata = nullptr;
@@ -414,6 +576,654 @@ std::vector<std::pair<std::string, std::string> >* Object::getExistingMetaData()
   return result;
 }
 
+/** Direct download **/
+
+/**
+ * Returns where the downloaded bytes at _offset go; _room is set to the
+ * size of that region, 0 once the destination is full.
+ */
+typedef function<char*(uint64_t _offset, uint64_t &_room)> RegionProvider;
+
+/**
+ * Called once _length bytes were received into the region at _offset
+ */
+typedef function<bool(uint64_t _offset, uint64_t _length)> RegionWriter;
+
+static SwiftResult<uint64_t*>* directDownload(Object &_object,
+    uint64_t _capacity, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap, const RegionProvider &_provider,
+    const RegionWriter &_writer) {
+  Container *container = _object.getContainer();
+  if (container == nullptr)
+    return returnNullError<uint64_t*>("container");
+  SwiftResult<uint64_t*> *result = new SwiftResult<uint64_t*>();
+  result->setPayload(nullptr);
+
+  //Never through ContentCache: the body has to come from the connection
+  string path = container->getName() + "/" + _object.getName();
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_OK);
+  validHTTPCodes.push_back(HTTPResponse::HTTP_PARTIAL_CONTENT);
+  //The response and the connection move over to our result
+  SwiftResult<istream*>* get = doSwiftTransaction<istream*>(
+      container->getAccount(), path, HTTPRequest::HTTP_GET, _uriParams,
+      _reqMap, &validHTTPCodes, nullptr, 0, nullptr);
+  result->setError(get->getError());
+  result->setResponse(get->getResponse());
+  result->setSession(get->getSession());
+  istream *stream = get->getPayload();
+  get->setResponse(nullptr);
+  get->setSession(nullptr);
+  delete get;
+  if (result->getError().code != SWIFT_OK.code)
+    return result;
+
+  HTTPResponse *response = result->getResponse();
+  PooledHTTPClientSession *session =
+      dynamic_cast<PooledHTTPClientSession*>(result->getSession());
+  streamsize contentLength = response->getContentLength();
+  uint64_t length = contentLength;
+  //Chunked bodies have to be decoded by the response stream
+  bool direct = session != nullptr
+      && contentLength != HTTPMessage::UNKNOWN_CONTENT_LENGTH
+      && !response->getChunkedTransferEncoding();
+  if (direct && length > _capacity) {
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL,
+        "Object is " + to_string(length) + " bytes, destination holds "
+            + to_string(_capacity)));
+    return result;
+  }
+
+  uint64_t received = 0;
+  string failure;
+  try {
+    while (!direct || received < length) {
+      uint64_t room = 0;
+      char *region = _provider(received, room);
+      if (direct)
+        room = min(room, length - received);
+      else if (room == 0) {
+        if (stream->rdbuf()->sgetc() != char_traits<char>::eof())
+          failure = "Object does not fit in " + to_string(_capacity)
+              + " bytes";
+        break;
+      }
+      room = min<uint64_t>(room, INT_MAX);
+      streamsize count =
+          direct ? session->readResponseBody(region, room) :
+              stream->rdbuf()->sgetn(region, room);
+      if (count <= 0)
+        break;
+      if (!_writer(received, count)) {
+        failure = "Failed to store data at offset " + to_string(received);
+        break;
+      }
+      received += count;
+    }
+  } catch (Exception &e) {
+    failure = e.displayText();
+  }
+  if (direct && failure.empty() && received != length)
+    failure = "Connection closed after " + to_string(received) + " of "
+        + to_string(length) + " bytes";
+  if (direct)
+    session->endResponseBody(failure.empty());
+
+  if (!failure.empty()) {
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL, failure));
+    return result;
+  }
+  result->setPayload(new uint64_t(received));
+  return result;
+}
+
+SwiftResult<uint64_t*>* Object::swiftGetObjectContentInto(char* _buffer,
+    size_t _capacity, std::vector<HTTPHeader>* _uriParams,
+    std::vector<HTTPHeader>* _reqMap) {
+  if (container == nullptr)
+    return returnNullError<uint64_t*>("container");
+  if (_buffer == nullptr)
+    return returnNullError<uint64_t*>("buffer");
+
+  RegionProvider provider = [_buffer, _capacity](uint64_t _offset,
+      uint64_t &_room) {
+    _room = _capacity - _offset;
+    return _buffer + _offset;
+  };
+  RegionWriter writer = [](uint64_t _offset, uint64_t _length) {
+    return true;
+  };
+  return directDownload(*this, _capacity, _uriParams, _reqMap, provider,
+      writer);
+}
+
+SwiftResult<uint64_t*>* Object::swiftGetObjectContentToFd(int _fd,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+  if (container == nullptr)
+    return returnNullError<uint64_t*>("container");
+
+  //The socket fills this buffer, which goes to the file as is
+  vector<char> chunk(1024 * 1024);
+  RegionProvider provider = [&chunk](uint64_t _offset, uint64_t &_room) {
+    _room = chunk.size();
+    return chunk.data();
+  };
+  RegionWriter writer = [_fd, &chunk](uint64_t _offset, uint64_t _length) {
+    uint64_t written = 0;
+    while (written < _length) {
+      ssize_t n = write(_fd, chunk.data() + written, _length - written);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      written += n;
+    }
+    return true;
+  };
+  return directDownload(*this, UINT64_MAX, _uriParams, _reqMap, provider,
+      writer);
+}
+
+/** Parallel ranged download **/
+
+/**
+ * Writes one downloaded part of _length bytes at _offset
+ */
+typedef function<bool(uint64_t _offset, istream &_input, uint64_t _length)> PartWriter;
+
+/**
+ * Returns the hex MD5 of the first _length downloaded bytes
+ */
+typedef function<string(uint64_t _length)> DownloadDigest;
+
+static SwiftResult<uint64_t*>* parallelDownload(Object &_object,
+    uint64_t _capacity, const TransferOptions &_options,
+    const PartWriter &_writer, const DownloadDigest &_digest) {
+  SwiftResult<uint64_t*> *result = new SwiftResult<uint64_t*>();
+  result->setPayload(nullptr);
+
+  //Find out length and ETag of the object; the ETag becomes If-Match, so
+  //it must not come from the stat cache
+  SwiftResult<int*>* head = _object.swiftShowMetadata(nullptr, false, true);
+  if (head->getError().code != SWIFT_OK.code) {
+    result->setError(head->getError());
+    delete head;
+    return result;
+  }
+  streamsize contentLength = head->getResponse()->getContentLength();
+  uint64_t length = contentLength;
+  string etag = head->getResponse()->get("ETag", "");
+  bool segmented = head->getResponse()->has("X-Object-Manifest")
+      || head->getResponse()->has("X-Static-Large-Object");
+  delete head;
+
+  if (contentLength == HTTPMessage::UNKNOWN_CONTENT_LENGTH) {
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL,
+        "Object length is unknown"));
+    return result;
+  }
+  if (length > _capacity) {
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL,
+        "Object is " + to_string(length) + " bytes, destination holds "
+            + to_string(_capacity)));
+    return result;
+  }
+
+  uint64_t partSize = max<uint64_t>(_options.partSize, 1);
+  uint64_t numParts = (length + partSize - 1) / partSize;
+  uint32_t numThreads = min<uint64_t>(max<uint32_t>(_options.parallelism, 1),
+      numParts);
+
+  atomic<uint64_t> nextPart(0);
+  atomic<bool> failed(false);
+  mutex errorMutex;
+  SwiftError error = SWIFT_OK;
+
+  runOnThreads(numThreads, [&]() {
+    while (!failed) {
+      uint64_t part = nextPart++;
+      if (part >= numParts)
+        return;
+      uint64_t offset = part * partSize;
+      uint64_t partLength = min(partSize, length - offset);
+
+      vector<HTTPHeader> reqMap;
+      reqMap.push_back(HTTPHeader("Range", "bytes=" + to_string(offset) + "-"
+          + to_string(offset + partLength - 1)));
+      //All parts must come from the same version of the object
+      if (!segmented && !etag.empty())
+        reqMap.push_back(HTTPHeader("If-Match", etag));
+
+      SwiftResult<istream*>* partResult = _object.swiftGetObjectContent(nullptr,
+          &reqMap);
+      SwiftError partError = partResult->getError();
+      if (partError.code == SWIFT_OK.code) {
+        streamsize received = partResult->getResponse()->getContentLength();
+        if (received != HTTPMessage::UNKNOWN_CONTENT_LENGTH
+            && (uint64_t) received != partLength)
+          partError = SwiftError(SwiftError::SWIFT_FAIL,
+              "Range request at offset " + to_string(offset) + " returned "
+                  + to_string(received) + " bytes instead of "
+                  + to_string(partLength));
+        else if (!_writer(offset, *partResult->getPayload(), partLength))
+          partError = SwiftError(SwiftError::SWIFT_FAIL,
+              "Failed to store part at offset " + to_string(offset));
+      }
+      delete partResult;
+
+      if (partError.code != SWIFT_OK.code) {
+        lock_guard<mutex> guard(errorMutex);
+        if (!failed) {
+          error = partError;
+          failed = true;
+        }
+      }
+    }
+  });
+
+  if (failed) {
+    result->setError(error);
+    return result;
+  }
+
+  //The ETag of a segmented object is not the MD5 of its content
+  if (_options.verifyETag && !segmented && !etag.empty()
+      && _digest(length) != normalizeETag(etag)) {
+    result->setError(SwiftError(SwiftError::SWIFT_CHECKSUM_ERROR,
+        "Downloaded content does not match ETag " + etag));
+    return result;
+  }
+
+  result->setError(SWIFT_OK);
+  result->setPayload(new uint64_t(length));
+  return result;
+}
+
+SwiftResult<uint64_t*>* Object::swiftGetObjectContentParallel(char* _buffer,
+    uint64_t _capacity, const TransferOptions &_options) {
+  if (container == nullptr)
+    return returnNullError<uint64_t*>("container");
+  if (_buffer == nullptr)
+    return returnNullError<uint64_t*>("buffer");
+
+  PartWriter writer = [_buffer](uint64_t _offset, istream &_input,
+      uint64_t _length) {
+    _input.read(_buffer + _offset, _length);
+    return (uint64_t) _input.gcount() == _length;
+  };
+  DownloadDigest digest = [_buffer](uint64_t _length) {
+    MD5Engine md5;
+    md5.update(_buffer, _length);
+    return DigestEngine::digestToHex(md5.digest());
+  };
+  return parallelDownload(*this, _capacity, _options, writer, digest);
+}
+
+SwiftResult<uint64_t*>* Object::swiftGetObjectContentParallelToFd(int _fd,
+    uint64_t _fileOffset, const TransferOptions &_options) {
+  if (container == nullptr)
+    return returnNullError<uint64_t*>("container");
+  const size_t chunkSize = 1024 * 1024;
+
+  PartWriter writer = [_fd, _fileOffset, chunkSize](uint64_t _offset,
+      istream &_input, uint64_t _length) {
+    vector<char> chunk(chunkSize);
+    while (_length > 0) {
+      _input.read(chunk.data(), min<uint64_t>(chunkSize, _length));
+      size_t received = _input.gcount();
+      if (received == 0)
+        return false;
+      size_t written = 0;
+      while (written < received) {
+        ssize_t n = pwrite(_fd, chunk.data() + written, received - written,
+            _fileOffset + _offset + written);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0)
+          return false;
+        written += n;
+      }
+      _offset += received;
+      _length -= received;
+    }
+    return true;
+  };
+  DownloadDigest digest = [_fd, _fileOffset, chunkSize](uint64_t _length) {
+    MD5Engine md5;
+    vector<char> chunk(chunkSize);
+    uint64_t offset = 0;
+    while (offset < _length) {
+      ssize_t n = pread(_fd, chunk.data(),
+          min<uint64_t>(chunkSize, _length - offset), _fileOffset + offset);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return string();
+      md5.update(chunk.data(), n);
+      offset += n;
+    }
+    return DigestEngine::digestToHex(md5.digest());
+  };
+  return parallelDownload(*this, UINT64_MAX, _options, writer, digest);
+}
+
+/** File upload **/
+
+/**
+ * Read-only mapping of a whole file, unmapped when it goes out of scope.
+ * Empty files are valid and point at an empty string.
+ */
+class MappedFile {
+  void* data;
+  uint64_t size;
+  std::string path;
+  int savedErrno;
+
+public:
+  MappedFile(const std::string &_path) :
+      data(MAP_FAILED), size(0), path(_path), savedErrno(0) {
+    int fd = open(_path.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0) {
+      savedErrno = errno;
+      if (fd >= 0)
+        close(fd);
+      return;
+    }
+    size = fileStat.st_size;
+    if (size == 0)
+      data = const_cast<char*>("");
+    else {
+      data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED)
+        savedErrno = errno;
+      else
+        //Pages are consumed front to back: read ahead aggressively
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    //The mapping stays valid after the descriptor is closed
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data != MAP_FAILED && size > 0)
+      munmap(data, size);
+  }
+
+  bool isValid() const {
+    return data != MAP_FAILED;
+  }
+
+  const char* getData() const {
+    return static_cast<const char*>(data);
+  }
+
+  uint64_t getSize() const {
+    return size;
+  }
+
+  template<class T>
+  SwiftResult<T>* openError() const {
+    SwiftResult<T> *result = new SwiftResult<T>();
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL,
+        "Cannot open " + path + ": " + strerror(savedErrno)));
+    result->setPayload(nullptr);
+    return result;
+  }
+};
+
+SwiftResult<int*>* Object::swiftUploadFile(const std::string &_filePath,
+    bool _calculateETag, std::vector<HTTPHeader> *_uriParams,
+    std::vector<HTTPHeader> *_reqMap) {
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+
+  MappedFile file(_filePath);
+  if (!file.isValid())
+    return file.openError<int*>();
+  //Blocks until the whole body is sent, so the mapping outlives the request
+  return swiftCreateReplaceObject(file.getData(), file.getSize(),
+      _calculateETag, _uriParams, _reqMap);
+}
+
+/** Static Large Object upload **/
+
+/**
+ * Returns the _length bytes at _offset of the content being uploaded;
+ * _scratch may be used as storage. Returns nullptr on failure.
+ */
+typedef function<const char*(uint64_t _offset, uint64_t _length,
+    vector<char> &_scratch)> SegmentReader;
+
+static SwiftResult<int*>* uploadSLO(Object &_object, uint64_t _size,
+    Container &_segmentContainer, const TransferOptions &_options,
+    const SegmentReader &_reader, vector<HTTPHeader> *_reqMap) {
+  uint64_t segmentSize = _options.partSize;
+  if (segmentSize == 0 || segmentSize > TransferOptions::MAX_OBJECT_SIZE) {
+    SwiftResult<int*> *result = new SwiftResult<int*>();
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL,
+        "Invalid segment size " + to_string(segmentSize)));
+    result->setPayload(nullptr);
+    return result;
+  }
+  //SLO refuses a manifest of one empty segment: store it as is
+  if (_size == 0)
+    return _object.swiftCreateReplaceObject("", 0, true, nullptr, _reqMap);
+  uint64_t numSegments = (_size + segmentSize - 1) / segmentSize;
+  uint32_t numThreads = min<uint64_t>(max<uint32_t>(_options.parallelism, 1),
+      numSegments);
+
+  //Same naming scheme as the swift command line client
+  ostringstream prefixStream;
+  prefixStream << _object.getName() << "/slo/" << Timestamp().epochMicroseconds()
+      << "/" << _size << "/" << segmentSize << "/";
+  string prefix = prefixStream.str();
+
+  vector<SLOSegment> segments(numSegments);
+  atomic<uint64_t> nextSegment(0);
+  atomic<bool> failed(false);
+  mutex errorMutex;
+  SwiftError error = SWIFT_OK;
+
+  runOnThreads(numThreads, [&]() {
+    vector<char> scratch;
+    while (!failed) {
+      uint64_t index = nextSegment++;
+      if (index >= numSegments)
+        return;
+      uint64_t offset = index * segmentSize;
+      uint64_t length = min(segmentSize, _size - offset);
+      ostringstream nameStream;
+      nameStream << prefix << setw(8) << setfill('0') << index;
+      Object segment(&_segmentContainer, nameStream.str());
+
+      SwiftError segmentError = SWIFT_OK;
+      for (uint32_t attempt = 0; attempt <= _options.retries; attempt++) {
+        const char* data = _reader(offset, length, scratch);
+        if (data == nullptr) {
+          segmentError = SwiftError(SwiftError::SWIFT_FAIL,
+              "Failed to read segment at offset " + to_string(offset));
+          break;
+        }
+        SwiftResult<int*>* segmentResult = segment.swiftCreateReplaceObject(
+            data, length, true);
+        segmentError = segmentResult->getError();
+        if (segmentError.code == SWIFT_OK.code)
+          segments[index].etag = normalizeETag(
+              segmentResult->getResponse()->get("ETag", ""));
+        delete segmentResult;
+        if (segmentError.code == SWIFT_OK.code)
+          break;
+      }
+
+      if (segmentError.code != SWIFT_OK.code) {
+        lock_guard<mutex> guard(errorMutex);
+        if (!failed) {
+          error = segmentError;
+          failed = true;
+        }
+        return;
+      }
+      segments[index].path = "/" + _segmentContainer.getName() + "/"
+          + segment.getName();
+      segments[index].size = length;
+    }
+  });
+
+  if (failed) {
+    //Best effort removal of the segments which made it
+    for (SLOSegment &uploaded : segments)
+      if (!uploaded.path.empty()) {
+        Object segment(&_segmentContainer,
+            uploaded.path.substr(_segmentContainer.getName().size() + 2));
+        delete segment.swiftDeleteObject();
+      }
+    SwiftResult<int*> *result = new SwiftResult<int*>();
+    result->setError(error);
+    result->setPayload(nullptr);
+    return result;
+  }
+
+  return _object.swiftCreateSLOManifest(segments, _reqMap);
+}
+
+SwiftResult<int*>* Object::swiftCreateReplaceObjectSLO(const char* _data,
+    uint64_t _size, Container &_segmentContainer,
+    const TransferOptions &_options, std::vector<HTTPHeader> *_reqMap) {
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  if (_data == nullptr && _size > 0)
+    return returnNullError<int*>("data");
+
+  SegmentReader reader = [_data](uint64_t _offset, uint64_t _length,
+      vector<char> &_scratch) {
+    return _data + _offset;
+  };
+  return uploadSLO(*this, _size, _segmentContainer, _options, reader, _reqMap);
+}
+
+SwiftResult<int*>* Object::swiftUploadFileSLO(const std::string &_filePath,
+    Container &_segmentContainer, const TransferOptions &_options,
+    std::vector<HTTPHeader> *_reqMap) {
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+
+  MappedFile file(_filePath);
+  if (!file.isValid())
+    return file.openError<int*>();
+
+  SegmentReader reader = [&file](uint64_t _offset, uint64_t _length,
+      vector<char> &_scratch) -> const char* {
+    return file.getData() + _offset;
+  };
+  return uploadSLO(*this, file.getSize(), _segmentContainer, _options, reader,
+      _reqMap);
+}
+
+SwiftResult<int*>* Object::swiftCreateSLOManifest(
+    const std::vector<SLOSegment> &_segments,
+    std::vector<HTTPHeader> *_reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  /**
+   * Check HTTP return code
+   * 201:
+   *  Manifest was created
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+
+  Json::Value manifest(Json::arrayValue);
+  for (const SLOSegment &segment : _segments) {
+    Json::Value entry;
+    entry["path"] = segment.path;
+    entry["etag"] = segment.etag;
+    entry["size_bytes"] = Json::UInt64(segment.size);
+    manifest.append(entry);
+  }
+  Json::FastWriter writer;
+  string manifestBody = writer.write(manifest);
+
+  vector<HTTPHeader> uriParams;
+  uriParams.push_back(HTTPHeader("multipart-manifest", "put"));
+
+  //Do swift transaction
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, &uriParams, _reqMap, &validHTTPCodes,
+      manifestBody.c_str(), manifestBody.size(), nullptr);
+}
+
+SwiftResult<int*>* Object::swiftCreateDLOManifest(Container &_segmentContainer,
+    const std::string &_prefix, std::vector<HTTPHeader> *_reqMap) {
+  //Check Container
+  if (container == nullptr)
+    return returnNullError<int*>("container");
+  //Path
+  string path = container->getName() + "/" + name;
+  /**
+   * Check HTTP return code
+   * 201:
+   *  Manifest was created
+   */
+  vector<int> validHTTPCodes;
+  validHTTPCodes.push_back(HTTPResponse::HTTP_CREATED);
+
+  vector<HTTPHeader> reqMap;
+  if (_reqMap != nullptr)
+    reqMap = *_reqMap;
+  string manifest;
+  URI::encode(_segmentContainer.getName() + "/" + _prefix, "", manifest);
+  reqMap.push_back(HTTPHeader("X-Object-Manifest", manifest));
+
+  //Do swift transaction
+  return doSwiftTransaction<int*>(container->getAccount(), path,
+      HTTPRequest::HTTP_PUT, nullptr, &reqMap, &validHTTPCodes, "", 0,
+      nullptr);
+}
+
+future<SwiftResult<istream*>*> Object::swiftGetObjectContentAsync(
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+  Object self(*this);
+  shared_ptr<vector<HTTPHeader> > uriParams = copyHeaders(_uriParams);
+  shared_ptr<vector<HTTPHeader> > reqMap = copyHeaders(_reqMap);
+  return Executor::getDefault().submit([self, uriParams, reqMap]() mutable {
+    return self.swiftGetObjectContent(uriParams.get(), reqMap.get());
+  });
+}
+
+future<SwiftResult<int*>*> Object::swiftCreateReplaceObjectAsync(
+    const char* _data, uint64_t _size, bool _calculateETag,
+    std::vector<HTTPHeader>* _uriParams, std::vector<HTTPHeader>* _reqMap) {
+  Object self(*this);
+  shared_ptr<vector<HTTPHeader> > uriParams = copyHeaders(_uriParams);
+  shared_ptr<vector<HTTPHeader> > reqMap = copyHeaders(_reqMap);
+  return Executor::getDefault().submit(
+      [self, _data, _size, _calculateETag, uriParams, reqMap]() mutable {
+        return self.swiftCreateReplaceObject(_data, _size, _calculateETag,
+            uriParams.get(), reqMap.get());
+      });
+}
+
+future<SwiftResult<istream*>*> Object::swiftDeleteObjectAsync(
+    bool _multipartManifest) {
+  Object self(*this);
+  return Executor::getDefault().submit([self, _multipartManifest]() mutable {
+    return self.swiftDeleteObject(_multipartManifest);
+  });
+}
+
+future<SwiftResult<int*>*> Object::swiftShowMetadataAsync(
+    std::vector<HTTPHeader>* _uriParams, bool _newest) {
+  Object self(*this);
+  shared_ptr<vector<HTTPHeader> > uriParams = copyHeaders(_uriParams);
+  return Executor::getDefault().submit([self, uriParams, _newest]() mutable {
+    return self.swiftShowMetadata(uriParams.get(), _newest);
+  });
+}
+
 Container* Object::getContainer() {
   return container;
 }
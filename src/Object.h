@@ -20,14 +20,61 @@
 #ifndef OBJECT_H_
 #define OBJECT_H_
 
+#include "BodySource.h"
 #include "Container.h"
+#include "Preconditions.h"
 #include "swiftcpp_export.h"
 
 #include <Poco/HashMap.h>
 #include <Poco/Net/HTTPClientSession.h>
+#include <future>
 
 namespace Swift {
 
+/**
+ * Tuning of the parallel transfer functions
+ */
+struct SWIFTCPP_EXPORT TransferOptions {
+  /**
+   * Size of each ranged request or uploaded segment
+   */
+  uint64_t partSize = 64 * 1024 * 1024;
+
+  /**
+   * Number of requests in flight at the same time
+   */
+  uint32_t parallelism = 8;
+
+  /**
+   * Check the data against the object ETag; skipped for segmented objects
+   * whose ETag is not the MD5 of their content.
+   */
+  bool verifyETag = true;
+
+  /**
+   * How many times a failed segment upload is retried on its own
+   */
+  uint32_t retries = 3;
+
+  /**
+   * Largest single object Swift accepts by default (max_file_size), hence
+   * the largest usable partSize.
+   */
+  static constexpr uint64_t MAX_OBJECT_SIZE = 5368709122ULL;
+};
+
+/**
+ * One segment of a Static Large Object manifest
+ */
+struct SWIFTCPP_EXPORT SLOSegment {
+  /**
+   * /<container>/<object> of the segment
+   */
+  std::string path;
+  std::string etag;
+  uint64_t size = 0;
+};
+
 class SWIFTCPP_EXPORT Object {
   Container* container;
   std::string name;
@@ -59,6 +106,8 @@ public:
 
   /**
    * Returns content of this Object
+   * Without parameters the read goes through ContentCache when it is
+   * enabled.
    * @return
    *  An stream containing content of this object.
    */
@@ -66,6 +115,39 @@ public:
       std::vector<HTTPHeader> *_uriParams = nullptr,
       std::vector<HTTPHeader> *_reqMap = nullptr);
 
+  /**
+   * Conditional read, never answered from ContentCache.
+   * @return
+   *  Error SWIFT_NOT_MODIFIED (304) or SWIFT_PRECONDITION_FAILED (412)
+   *  when the condition does not hold; the stream is then empty.
+   */
+  SwiftResult<std::istream*>* swiftGetObjectContent(
+      const Preconditions &_preconditions,
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Downloads the content of this object into _buffer. Bodies with a
+   * Content-Length are read from the connection straight into _buffer,
+   * without going through the response stream.
+   * @return
+   *  Number of bytes written to _buffer; fails if the object does not fit
+   *  in _capacity bytes.
+   */
+  SwiftResult<uint64_t*>* swiftGetObjectContentInto(char* _buffer,
+      size_t _capacity, std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Same as swiftGetObjectContentInto but the content is written to _fd at
+   * its current offset.
+   * @return
+   *  Number of bytes written to _fd.
+   */
+  SwiftResult<uint64_t*>* swiftGetObjectContentToFd(int _fd,
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
   /**
    * Creates or replace this object (if already exist)
    * @return
@@ -77,9 +159,49 @@ public:
    * _calculateETag
    *  Whether to calculate ETag for this object or not; it's highly
    *  recommended to do so because it'll check the integrity of object
-   *  on the server.
+   *  on the server. The MD5 is computed while the data is sent and
+   *  compared with the ETag the server returns; a mismatch is reported
+   *  as HTTP 422 (Unprocessable Entity).
    */
-  SwiftResult<int*>* swiftCreateReplaceObject(const char* _data, uint32_t _size,
+  SwiftResult<int*>* swiftCreateReplaceObject(const char* _data, uint64_t _size,
+      bool _calculateETag = true, std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Same as above with content pulled from _body while it is sent, with
+   * a Content-Length and without chunked transfer encoding. _body is
+   * rewound if the request has to be sent again.
+   */
+  SwiftResult<int*>* swiftCreateReplaceObject(BodySource &_body,
+      bool _calculateETag = true, std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Conditional create or replace, e.g. Preconditions().ifNoneMatchAny()
+   * to create only if the object does not exist yet.
+   * @return
+   *  Error SWIFT_PRECONDITION_FAILED (412) when the condition does not
+   *  hold and nothing was written.
+   */
+  SwiftResult<int*>* swiftCreateReplaceObject(const char* _data, uint64_t _size,
+      const Preconditions &_preconditions, bool _calculateETag = true,
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+  SwiftResult<int*>* swiftCreateReplaceObject(BodySource &_body,
+      const Preconditions &_preconditions, bool _calculateETag = true,
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Creates or replaces this object with the content of the file at
+   * _filePath. The file is mapped into memory and sent straight from the
+   * page cache, so nothing is copied into user space buffers.
+   * @return
+   *  Nothing.
+   * _calculateETag
+   *  Same as swiftCreateReplaceObject.
+   */
+  SwiftResult<int*>* swiftUploadFile(const std::string &_filePath,
       bool _calculateETag = true, std::vector<HTTPHeader> *_uriParams = nullptr,
       std::vector<HTTPHeader> *_reqMap = nullptr);
 
@@ -87,7 +209,7 @@ public:
    * In order to create a variable length object you need to use this fucntion.
    * You need to pass a pointer to an outputstream then you can use that to write
    * as much as data you want in this object; however, there is a max limit of
-   * 5GB for each object.
+   * 5GB for each object. Use SegmentedObjectWriter for larger objects.
    * How to use this function:
    * you should pass a outputStream pointer so you will have access to an output stream to write your data
    * this pointer is valid as long as you call httpclientsession->recveiveRespone() to receive actual response
@@ -103,13 +225,18 @@ public:
    * if(response.getStatus() == HTTP_CREATED)
    * success.
    *
+   * If _calculateETag is set, the returned stream hashes the data as it is
+   * written and receiveResponse() compares the MD5 with the ETag returned by
+   * the server; on mismatch the response status is 422 (Unprocessable
+   * Entity) instead of 201.
+   *
    * @return
    *   A pointer to the httpsession to the Swift server so you can send your request after you are
    *   done with writing your content to this object.
    */
   SwiftResult<Poco::Net::HTTPClientSession*>* swiftCreateReplaceObject(
       std::ostream* &ouputStream, std::vector<HTTPHeader> *_uriParams = nullptr,
-      std::vector<HTTPHeader> *_reqMap = nullptr);
+      std::vector<HTTPHeader> *_reqMap = nullptr, bool _calculateETag = true);
 
   /**
    * Makes a copy of this object to another object on the server.
@@ -126,12 +253,13 @@ public:
   /**
    * Deletes this object form server.
    * _multipartManifest
-   *  Used for multipart objects(not implemented yet)
+   *  Set for a static large object to delete its segments as well.
    */
   SwiftResult<std::istream*>* swiftDeleteObject(
       bool _multipartManifest = false);
   /**
-   * Adds metadata to this Object
+   * Adds metadata to this Object. Keeping the existing metadata costs a
+   * HEAD per call; MetadataSession avoids it for repeated updates.
    * @return
    *  Nothing
    * _metaData
@@ -166,9 +294,131 @@ public:
    * @return
    *  Nothing. The payload is nullptr; however, the returned metadata are
    *  part of httpresponse. For example, getResponse()->write(cout);
+   * _bypassStatCache
+   *  Always ask the server, e.g. before a read-modify-write of the
+   *  metadata; the answer still refreshes the account's stat cache.
    */
   SwiftResult<int*>* swiftShowMetadata(std::vector<HTTPHeader>* _uriParams =
-      nullptr, bool _newest = false);
+      nullptr, bool _newest = false, bool _bypassStatCache = false);
+
+  /**
+   * Conditional HEAD, never answered from the stat cache.
+   * @return
+   *  Error SWIFT_NOT_MODIFIED (304) or SWIFT_PRECONDITION_FAILED (412)
+   *  when the condition does not hold.
+   */
+  SwiftResult<int*>* swiftShowMetadata(const Preconditions &_preconditions,
+      bool _newest = false);
+
+  /**
+   * Same as swiftShowMetadata with the response parsed. Both answer from
+   * the account's stat cache when it is on (see Account::setStatCache).
+   * @return
+   *  The payload is set when the object was found, and with exists false
+   *  when it does not exist (error SWIFT_HTTP_ERROR, 404).
+   */
+  SwiftResult<ObjectStat*>* swiftStat(bool _newest = false);
+
+  /**
+   * Downloads this object into _buffer with several concurrent ranged
+   * GETs of _options.partSize bytes each.
+   * @return
+   *  The number of bytes written to _buffer.
+   * _buffer
+   *  Destination; must hold the whole object.
+   * _capacity
+   *  Size of _buffer.
+   */
+  SwiftResult<uint64_t*>* swiftGetObjectContentParallel(char* _buffer,
+      uint64_t _capacity, const TransferOptions &_options = TransferOptions());
+
+  /**
+   * Same as swiftGetObjectContentParallel but every part is written with
+   * pwrite() at its offset in the file _fd (plus _fileOffset).
+   * @return
+   *  The number of bytes written to _fd.
+   */
+  SwiftResult<uint64_t*>* swiftGetObjectContentParallelToFd(int _fd,
+      uint64_t _fileOffset = 0,
+      const TransferOptions &_options = TransferOptions());
+
+  /**
+   * Creates or replaces this object as a Static Large Object. _data is cut
+   * into segments of _options.partSize bytes which are uploaded
+   * concurrently to _segmentContainer, each with its own ETag; a failed
+   * segment is retried on its own. Then the manifest is written to this
+   * object with multipart-manifest=put. Empty content is stored with a
+   * plain PUT, as SLO accepts no empty segment.
+   * @return
+   *  Result of the manifest PUT.
+   * _segmentContainer
+   *  Existing container which receives the segments
+   *  (<name>/slo/<timestamp>/<size>/<segment size>/<index>).
+   * _reqMap
+   *  Headers of the manifest PUT, e.g. Content-Type or metadata.
+   */
+  SwiftResult<int*>* swiftCreateReplaceObjectSLO(const char* _data,
+      uint64_t _size, Container &_segmentContainer,
+      const TransferOptions &_options = TransferOptions(),
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Same as swiftCreateReplaceObjectSLO but the content is the file at
+   * _filePath; the file is mapped and each segment is sent straight from
+   * the mapping.
+   */
+  SwiftResult<int*>* swiftUploadFileSLO(const std::string &_filePath,
+      Container &_segmentContainer,
+      const TransferOptions &_options = TransferOptions(),
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Writes a Static Large Object manifest to this object
+   * (multipart-manifest=put).
+   * @return
+   *  Nothing.
+   * _segments
+   *  The segments in content order.
+   * _reqMap
+   *  Headers of the manifest PUT, e.g. Content-Type or metadata.
+   */
+  SwiftResult<int*>* swiftCreateSLOManifest(
+      const std::vector<SLOSegment> &_segments,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Writes a Dynamic Large Object manifest to this object; its content is
+   * every object of _segmentContainer whose name starts with _prefix, in
+   * name order.
+   * @return
+   *  Nothing.
+   */
+  SwiftResult<int*>* swiftCreateDLOManifest(Container &_segmentContainer,
+      const std::string &_prefix, std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /** Asynchronous API Functions **/
+
+  /**
+   * The ...Async functions run their blocking counterpart on
+   * Executor::getDefault() and return at once. This Object and the
+   * request parameters are copied; the Container, the Account and any
+   * data buffer must stay valid until the future is ready. The caller
+   * owns the SwiftResult returned by the future.
+   */
+  std::future<SwiftResult<std::istream*>*> swiftGetObjectContentAsync(
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  std::future<SwiftResult<int*>*> swiftCreateReplaceObjectAsync(
+      const char* _data, uint64_t _size, bool _calculateETag = true,
+      std::vector<HTTPHeader> *_uriParams = nullptr,
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  std::future<SwiftResult<std::istream*>*> swiftDeleteObjectAsync(
+      bool _multipartManifest = false);
+
+  std::future<SwiftResult<int*>*> swiftShowMetadataAsync(
+      std::vector<HTTPHeader>* _uriParams = nullptr, bool _newest = false);
 };
 
 } /* namespace Swift */
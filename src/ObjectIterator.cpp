@@ -0,0 +1,135 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ObjectIterator.h"
+#include "HTTPIO.h"
+
+using namespace std;
+using namespace Poco::Net;
+
+namespace Swift {
+
+ObjectIterator::ObjectIterator(Container *_container, uint32_t _pageSize,
+    const std::string &_prefix, const std::string &_marker, bool _newest) :
+    container(_container), pageSize(max<uint32_t>(_pageSize, 1)), prefix(
+        _prefix), newest(_newest), position(0), error(SWIFT_OK), pagesFetched(
+        0) {
+  prefetch(_marker);
+}
+
+ObjectIterator::~ObjectIterator() {
+  //The background request uses our container
+  if (nextPage.valid())
+    nextPage.wait();
+}
+
+void ObjectIterator::prefetch(const std::string &_marker) {
+  Container *container = this->container;
+  uint32_t pageSize = this->pageSize;
+  string prefix = this->prefix;
+  bool newest = this->newest;
+  nextPage = async(launch::async, [container, pageSize, prefix, _marker,
+      newest]() {
+    return fetchPage(container, pageSize, prefix, _marker, newest);
+  });
+}
+
+bool ObjectIterator::hasNext() {
+  while (position >= current.objects.size()) {
+    if (!nextPage.valid())
+      return false;
+    current = nextPage.get();
+    position = 0;
+    pagesFetched++;
+    if (current.error.code != SWIFT_OK.code) {
+      error = current.error;
+      current.objects.clear();
+      return false;
+    }
+    //Fetch the following page while this one is consumed
+    if (!current.last && !current.objects.empty())
+      prefetch(current.objects.back().getName());
+  }
+  return true;
+}
+
+Object ObjectIterator::next() {
+  return current.objects[position++];
+}
+
+SwiftError ObjectIterator::getError() const {
+  return error;
+}
+
+uint64_t ObjectIterator::getPagesFetched() const {
+  return pagesFetched;
+}
+
+ObjectPage ObjectIterator::fetchPage(Container *_container, uint32_t _limit,
+    const std::string &_prefix, const std::string &_marker, bool _newest) {
+  ObjectPage page;
+  //Objects are built while the body is still arriving
+  page.objects.reserve(_limit);
+  uint32_t entries = 0;
+  page.error = fetchEntries(_container, _limit, _prefix, _marker, "", _newest,
+      [&](const ListingEntry &_entry) {
+        if (_entry.subdir.empty())
+          page.objects.push_back(
+              Object(_container, _entry.name, _entry.bytes,
+                  _entry.contentType, _entry.hash, _entry.lastModified));
+        return true;
+      }, entries);
+  if (page.error.code != SWIFT_OK.code)
+    page.objects.clear();
+  page.last = entries < _limit;
+  return page;
+}
+
+SwiftError ObjectIterator::fetchEntries(Container *_container,
+    uint32_t _limit, const std::string &_prefix, const std::string &_marker,
+    const std::string &_endMarker, bool _newest,
+    const ListingCallback &_callback, uint32_t &_entries) {
+  _entries = 0;
+  if (_container == nullptr)
+    return SwiftError(SwiftError::SWIFT_FAIL, "container is NULL");
+
+  ListingQuery query;
+  query.limit(_limit).marker(_marker).endMarker(_endMarker).prefix(_prefix);
+  SwiftResult<istream*> *list = _container->swiftListObjects(query, _newest);
+  SwiftError error = list->getError();
+  //204: empty container
+  if (error.code != SWIFT_OK.code
+      || list->getResponse()->getStatus() == HTTPResponse::HTTP_NO_CONTENT) {
+    delete list;
+    return error;
+  }
+
+  string parseError;
+  bool parsed = ListingParser::parse(*list->getPayload(),
+      [&](const ListingEntry &_entry) {
+        _entries++;
+        return _callback(_entry);
+      }, parseError);
+  delete list;
+  if (!parsed)
+    return SwiftError(SwiftError::SWIFT_JSON_PARSE_ERROR, parseError);
+  return SWIFT_OK;
+}
+
+} /* namespace Swift */
@@ -0,0 +1,128 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef OBJECTITERATOR_H_
+#define OBJECTITERATOR_H_
+
+#include "ListingParser.h"
+#include "Object.h"
+#include "swiftcpp_export.h"
+
+#include <future>
+#include <memory>
+
+namespace Swift {
+
+/**
+ * One page of a container listing
+ */
+struct SWIFTCPP_EXPORT ObjectPage {
+  std::vector<Object> objects;
+  SwiftError error = SWIFT_OK;
+  /**
+   * Set when the server returned fewer names than asked for
+   */
+  bool last = false;
+};
+
+/**
+ * Lists every object of a container, however many there are. Names are
+ * fetched _pageSize at a time (marker/limit) and handed out one by one;
+ * while the caller goes through a page the next one is already being
+ * fetched in the background. At most two pages are held in memory.
+ *
+ * Example:
+ * ObjectIterator it(&container);
+ * while (it.hasNext())
+ *   cout << it.next().getName() << endl;
+ * if (it.getError().code != SWIFT_OK.code)
+ *   ...
+ */
+class SWIFTCPP_EXPORT ObjectIterator {
+private:
+  Container *container;
+  uint32_t pageSize;
+  std::string prefix;
+  bool newest;
+
+  ObjectPage current;
+  size_t position;
+  std::future<ObjectPage> nextPage;
+  SwiftError error;
+  uint64_t pagesFetched;
+
+  void prefetch(const std::string &_marker);
+
+public:
+  /**
+   * _container
+   *  Must outlive this iterator.
+   * _pageSize
+   *  Names per request; Swift returns at most 10000.
+   * _prefix
+   *  Only list names starting with this prefix.
+   * _marker
+   *  Start after this name.
+   */
+  ObjectIterator(Container *_container, uint32_t _pageSize = 10000,
+      const std::string &_prefix = "", const std::string &_marker = "",
+      bool _newest = false);
+  virtual ~ObjectIterator();
+
+  ObjectIterator(const ObjectIterator&) = delete;
+  ObjectIterator& operator=(const ObjectIterator&) = delete;
+
+  /**
+   * Whether next() has an object to return; may wait for the next page.
+   * Returns false at the end of the listing or on error.
+   */
+  bool hasNext();
+
+  /**
+   * Returns the next object; only valid after hasNext() returned true.
+   */
+  Object next();
+
+  /**
+   * SWIFT_OK unless fetching a page failed
+   */
+  SwiftError getError() const;
+
+  uint64_t getPagesFetched() const;
+
+  /**
+   * Fetches one listing page of _container: up to _limit objects after
+   * _marker. Used by the iterator, callable on its own.
+   */
+  static ObjectPage fetchPage(Container *_container, uint32_t _limit,
+      const std::string &_prefix, const std::string &_marker, bool _newest);
+
+  /**
+   * Same as fetchPage but the raw entries go to _callback as they are
+   * parsed; _entries is set to how many the server returned. A non empty
+   * _endMarker stops the listing before that name.
+   */
+  static SwiftError fetchEntries(Container *_container, uint32_t _limit,
+      const std::string &_prefix, const std::string &_marker,
+      const std::string &_endMarker, bool _newest,
+      const ListingCallback &_callback, uint32_t &_entries);
+};
+
+} /* namespace Swift */
+#endif /* OBJECTITERATOR_H_ */
@@ -0,0 +1,376 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ObjectListing.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace Swift {
+
+ObjectListing::ObjectListing(Container *_container) :
+    container(_container), sorted(true) {
+}
+
+ObjectListing::~ObjectListing() {
+}
+
+static int hexValue(char _c) {
+  if (_c >= '0' && _c <= '9')
+    return _c - '0';
+  if (_c >= 'a' && _c <= 'f')
+    return _c - 'a' + 10;
+  if (_c >= 'A' && _c <= 'F')
+    return _c - 'A' + 10;
+  return -1;
+}
+
+void ObjectListing::add(const ListingEntry &_entry) {
+  if (!_entry.subdir.empty())
+    return;
+  Record record;
+  record.nameOffset = names.size();
+  record.nameLength = _entry.name.size();
+  record.bytes = _entry.bytes;
+  record.lastModified = parseTimestamp(_entry.lastModified);
+
+  //Anything but 32 hex digits (never seen from Swift) is stored as zeros
+  memset(record.hash, 0, sizeof(record.hash));
+  if (_entry.hash.size() == 32) {
+    for (int i = 0; i < 16; i++) {
+      int high = hexValue(_entry.hash[2 * i]);
+      int low = hexValue(_entry.hash[2 * i + 1]);
+      if (high < 0 || low < 0) {
+        memset(record.hash, 0, sizeof(record.hash));
+        break;
+      }
+      record.hash[i] = (high << 4) | low;
+    }
+  }
+
+  map<string, uint32_t>::iterator type = contentTypeIndex.find(
+      _entry.contentType);
+  if (type == contentTypeIndex.end()) {
+    type = contentTypeIndex.insert(
+        make_pair(_entry.contentType, (uint32_t) contentTypes.size())).first;
+    contentTypes.push_back(_entry.contentType);
+  }
+  record.contentType = type->second;
+
+  if (!records.empty() && sorted)
+    sorted = _entry.name.compare(getName(records.size() - 1)) > 0;
+  names.append(_entry.name);
+  names.push_back('\0');
+  records.push_back(record);
+}
+
+void ObjectListing::append(const ObjectListing &_other) {
+  if (_other.records.empty())
+    return;
+  if (!records.empty() && sorted)
+    sorted = _other.sorted
+        && strcmp(_other.getName(0), getName(records.size() - 1)) > 0;
+  else if (records.empty())
+    sorted = _other.sorted;
+
+  //Map the content types of _other onto ours
+  vector<uint32_t> typeMap(_other.contentTypes.size());
+  for (size_t i = 0; i < _other.contentTypes.size(); i++) {
+    const string &type = _other.contentTypes[i];
+    map<string, uint32_t>::iterator it = contentTypeIndex.find(type);
+    if (it == contentTypeIndex.end()) {
+      it = contentTypeIndex.insert(
+          make_pair(type, (uint32_t) contentTypes.size())).first;
+      contentTypes.push_back(type);
+    }
+    typeMap[i] = it->second;
+  }
+
+  uint64_t offset = names.size();
+  names.append(_other.names);
+  records.reserve(records.size() + _other.records.size());
+  for (const Record &other : _other.records) {
+    Record record = other;
+    record.nameOffset += offset;
+    record.contentType = typeMap[other.contentType];
+    records.push_back(record);
+  }
+}
+
+void ObjectListing::sort() {
+  if (sorted)
+    return;
+  const char *arena = names.data();
+  std::sort(records.begin(), records.end(),
+      [arena](const Record &_a, const Record &_b) {
+        return strcmp(arena + _a.nameOffset, arena + _b.nameOffset) < 0;
+      });
+  sorted = true;
+}
+
+void ObjectListing::shrinkToFit() {
+  names.shrink_to_fit();
+  records.shrink_to_fit();
+}
+
+size_t ObjectListing::size() const {
+  return records.size();
+}
+
+bool ObjectListing::empty() const {
+  return records.empty();
+}
+
+const char* ObjectListing::getName(size_t _index) const {
+  return names.data() + records[_index].nameOffset;
+}
+
+uint32_t ObjectListing::getNameLength(size_t _index) const {
+  return records[_index].nameLength;
+}
+
+uint64_t ObjectListing::getBytes(size_t _index) const {
+  return records[_index].bytes;
+}
+
+const std::string& ObjectListing::getContentType(size_t _index) const {
+  return contentTypes[records[_index].contentType];
+}
+
+const uint8_t* ObjectListing::getHash(size_t _index) const {
+  return records[_index].hash;
+}
+
+std::string ObjectListing::getHashHex(size_t _index) const {
+  static const char digits[] = "0123456789abcdef";
+  string hex(32, '0');
+  for (int i = 0; i < 16; i++) {
+    hex[2 * i] = digits[records[_index].hash[i] >> 4];
+    hex[2 * i + 1] = digits[records[_index].hash[i] & 0xF];
+  }
+  return hex;
+}
+
+int64_t ObjectListing::getLastModified(size_t _index) const {
+  return records[_index].lastModified;
+}
+
+Object ObjectListing::getObject(size_t _index) const {
+  return Object(container,
+      string(getName(_index), records[_index].nameLength),
+      records[_index].bytes, getContentType(_index), getHashHex(_index),
+      formatTimestamp(records[_index].lastModified));
+}
+
+size_t ObjectListing::lowerBound(const std::string &_name) const {
+  //Names cannot hold NUL, so strcmp orders them like Swift does (bytewise)
+  size_t low = 0, high = records.size();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (strcmp(getName(middle), _name.c_str()) < 0)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+size_t ObjectListing::find(const std::string &_name) const {
+  if (!sorted) {
+    for (size_t i = 0; i < records.size(); i++)
+      if (_name == getName(i))
+        return i;
+    return records.size();
+  }
+  size_t index = lowerBound(_name);
+  if (index < records.size() && _name == getName(index))
+    return index;
+  return records.size();
+}
+
+/**
+ * Header of the binary form; integers are in host byte order, the files
+ * are local caches.
+ */
+struct ListingBlobHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t records;
+  uint64_t namesSize;
+  uint64_t typesSize;
+  uint32_t recordSize;
+  uint32_t sorted;
+};
+
+static const char LISTING_MAGIC[4] = { 'S', 'W', 'O', 'L' };
+
+bool ObjectListing::writeTo(std::ostream &_output) const {
+  string types;
+  for (const string &type : contentTypes) {
+    types.append(type);
+    types.push_back('\0');
+  }
+  ListingBlobHeader header;
+  memcpy(header.magic, LISTING_MAGIC, sizeof(header.magic));
+  header.version = 1;
+  header.records = records.size();
+  header.namesSize = names.size();
+  header.typesSize = types.size();
+  header.recordSize = sizeof(Record);
+  header.sorted = sorted;
+
+  _output.write((const char*) &header, sizeof(header));
+  _output.write((const char*) records.data(), records.size() * sizeof(Record));
+  _output.write(names.data(), names.size());
+  _output.write(types.data(), types.size());
+  return _output.good();
+}
+
+bool ObjectListing::readFrom(const char *_data, size_t _size) {
+  ListingBlobHeader header;
+  if (_size < sizeof(header))
+    return false;
+  memcpy(&header, _data, sizeof(header));
+  if (memcmp(header.magic, LISTING_MAGIC, sizeof(header.magic)) != 0
+      || header.version != 1 || header.recordSize != sizeof(Record))
+    return false;
+  uint64_t recordsSize = header.records * sizeof(Record);
+  if (_size - sizeof(header) < recordsSize
+      || _size - sizeof(header) - recordsSize < header.namesSize
+      || _size - sizeof(header) - recordsSize - header.namesSize
+          < header.typesSize)
+    return false;
+
+  const char *position = _data + sizeof(header);
+  records.resize(header.records);
+  memcpy((void*) records.data(), position, recordsSize);
+  position += recordsSize;
+  names.assign(position, header.namesSize);
+  position += header.namesSize;
+
+  contentTypes.clear();
+  contentTypeIndex.clear();
+  const char *typesEnd = position + header.typesSize;
+  while (position < typesEnd) {
+    const char *end = (const char*) memchr(position, '\0', typesEnd - position);
+    if (end == nullptr)
+      return false;
+    contentTypeIndex[string(position, end)] = contentTypes.size();
+    contentTypes.push_back(string(position, end));
+    position = end + 1;
+  }
+
+  //Do not trust offsets from disk
+  for (const Record &record : records)
+    if (record.nameOffset + record.nameLength >= names.size()
+        || record.contentType >= contentTypes.size()) {
+      records.clear();
+      names.clear();
+      return false;
+    }
+  sorted = header.sorted != 0;
+  return true;
+}
+
+uint64_t ObjectListing::getMemoryUsage() const {
+  uint64_t usage = names.capacity() + records.capacity() * sizeof(Record);
+  for (const string &type : contentTypes)
+    usage += 2 * type.capacity() + sizeof(string);
+  return usage;
+}
+
+Container* ObjectListing::getContainer() const {
+  return container;
+}
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date
+ */
+static int64_t daysFromCivil(int64_t _year, unsigned _month, unsigned _day) {
+  _year -= _month <= 2;
+  int64_t era = (_year >= 0 ? _year : _year - 399) / 400;
+  unsigned yearOfEra = (unsigned) (_year - era * 400);
+  unsigned dayOfYear = (153 * (_month + (_month > 2 ? -3 : 9)) + 2) / 5
+      + _day - 1;
+  unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100
+      + dayOfYear;
+  return era * 146097 + (int64_t) dayOfEra - 719468;
+}
+
+int64_t ObjectListing::parseTimestamp(const std::string &_timestamp) {
+  int year, month, day, hour, minute, second;
+  int consumed = 0;
+  if (sscanf(_timestamp.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%n", &year, &month,
+      &day, &hour, &minute, &second, &consumed) != 6)
+    return 0;
+  int64_t micro = 0;
+  //Fraction has up to 6 digits
+  if (_timestamp[consumed] == '.') {
+    int digits = 0;
+    for (size_t i = consumed + 1; i < _timestamp.size() && digits < 6; i++) {
+      if (_timestamp[i] < '0' || _timestamp[i] > '9')
+        break;
+      micro = micro * 10 + (_timestamp[i] - '0');
+      digits++;
+    }
+    for (; digits < 6; digits++)
+      micro *= 10;
+  }
+  int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600
+      + minute * 60 + second;
+  return seconds * 1000000 + micro;
+}
+
+std::string ObjectListing::formatTimestamp(int64_t _microseconds) {
+  int64_t seconds = _microseconds / 1000000;
+  int64_t micro = _microseconds % 1000000;
+  if (micro < 0) {
+    micro += 1000000;
+    seconds--;
+  }
+  int64_t days = seconds / 86400;
+  int64_t rest = seconds % 86400;
+  if (rest < 0) {
+    rest += 86400;
+    days--;
+  }
+  //Inverse of daysFromCivil
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned dayOfEra = (unsigned) (days - era * 146097);
+  unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+      - dayOfEra / 146096) / 365;
+  int64_t year = (int64_t) yearOfEra + era * 400;
+  unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4
+      - yearOfEra / 100);
+  unsigned monthPart = (5 * dayOfYear + 2) / 153;
+  unsigned day = dayOfYear - (153 * monthPart + 2) / 5 + 1;
+  unsigned month = monthPart < 10 ? monthPart + 3 : monthPart - 9;
+  year += month <= 2;
+
+  char buffer[40];
+  snprintf(buffer, sizeof(buffer), "%04d-%02u-%02uT%02d:%02d:%02d.%06d",
+      (int) year, month, day, (int) (rest / 3600), (int) (rest / 60 % 60),
+      (int) (rest % 60), (int) micro);
+  return buffer;
+}
+
+} /* namespace Swift */
@@ -0,0 +1,160 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef OBJECTLISTING_H_
+#define OBJECTLISTING_H_
+
+#include "ListingParser.h"
+#include "Object.h"
+#include "swiftcpp_export.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Swift {
+
+/**
+ * Compact listing of a container. Names live back to back in one
+ * NUL-separated arena, content types are interned, hashes are kept as
+ * 16 binary bytes and last modified times as microseconds since the
+ * epoch; an entry costs 48 bytes plus its name. Object handles are
+ * created on demand with getObject().
+ */
+class SWIFTCPP_EXPORT ObjectListing {
+private:
+  struct Record {
+    uint64_t nameOffset;
+    uint64_t bytes;
+    int64_t lastModified;
+    uint32_t nameLength;
+    uint32_t contentType;
+    uint8_t hash[16];
+  };
+
+  Container *container;
+  std::string names;
+  std::vector<Record> records;
+  std::vector<std::string> contentTypes;
+  std::map<std::string, uint32_t> contentTypeIndex;
+  bool sorted;
+
+public:
+  /**
+   * _container
+   *  Container of the listed objects; must outlive the Objects created
+   *  from this listing.
+   */
+  ObjectListing(Container *_container = nullptr);
+  virtual ~ObjectListing();
+
+  /**
+   * Appends a listing entry; pseudo directories (subdir) are ignored.
+   */
+  void add(const ListingEntry &_entry);
+
+  /**
+   * Appends all entries of _other, which must come after ours in name
+   * order to keep this listing sorted.
+   */
+  void append(const ObjectListing &_other);
+
+  /**
+   * Sorts the entries by name. Only needed if they were not added in
+   * listing order, which already is sorted.
+   */
+  void sort();
+
+  /**
+   * Gives back the memory reserved for growth
+   */
+  void shrinkToFit();
+
+  size_t size() const;
+  bool empty() const;
+
+  /**
+   * NUL terminated name of entry _index; valid while this listing is
+   * neither modified nor destroyed.
+   */
+  const char* getName(size_t _index) const;
+  uint32_t getNameLength(size_t _index) const;
+  uint64_t getBytes(size_t _index) const;
+  const std::string& getContentType(size_t _index) const;
+  /**
+   * 16 byte binary MD5
+   */
+  const uint8_t* getHash(size_t _index) const;
+  std::string getHashHex(size_t _index) const;
+  /**
+   * Microseconds since the epoch (UTC)
+   */
+  int64_t getLastModified(size_t _index) const;
+
+  /**
+   * Creates an Object handle for entry _index
+   */
+  Object getObject(size_t _index) const;
+
+  /**
+   * Binary search by name.
+   * @return
+   *  Index of _name, or size() if it is not listed.
+   */
+  size_t find(const std::string &_name) const;
+
+  /**
+   * Index of the first entry whose name is not less than _name
+   */
+  size_t lowerBound(const std::string &_name) const;
+
+  /**
+   * Writes this listing in a flat binary form: header, records, name
+   * arena and content types, so reading it back is a few memcpy calls.
+   * @return
+   *  Whether _output is still good.
+   */
+  bool writeTo(std::ostream &_output) const;
+
+  /**
+   * Replaces the entries of this listing with _size bytes written by
+   * writeTo(), e.g. from a mapped file. The container is kept.
+   * @return
+   *  false if the data is truncated or not a listing.
+   */
+  bool readFrom(const char *_data, size_t _size);
+
+  /**
+   * Approximate number of bytes held by this listing
+   */
+  uint64_t getMemoryUsage() const;
+
+  Container* getContainer() const;
+
+  /**
+   * Converts a Swift last_modified value (2014-12-01T10:33:27.581850, UTC)
+   * to microseconds since the epoch and back.
+   */
+  static int64_t parseTimestamp(const std::string &_timestamp);
+  static std::string formatTimestamp(int64_t _microseconds);
+};
+
+} /* namespace Swift */
+#endif /* OBJECTLISTING_H_ */
@@ -0,0 +1,84 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "Preconditions.h"
+#include <Poco/DateTimeFormat.h>
+#include <Poco/DateTimeFormatter.h>
+#include <Poco/Net/HTTPResponse.h>
+#include <Poco/Timestamp.h>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+static string httpDate(time_t _time) {
+  return DateTimeFormatter::format(Timestamp::fromEpochTime(_time),
+      DateTimeFormat::HTTP_FORMAT);
+}
+
+Preconditions& Preconditions::ifMatch(const string &_etag) {
+  ifMatchValue = _etag;
+  return *this;
+}
+
+Preconditions& Preconditions::ifNoneMatch(const string &_etag) {
+  ifNoneMatchValue = _etag;
+  return *this;
+}
+
+Preconditions& Preconditions::ifNoneMatchAny() {
+  ifNoneMatchValue = "*";
+  return *this;
+}
+
+Preconditions& Preconditions::ifModifiedSince(time_t _time) {
+  ifModifiedSinceValue = httpDate(_time);
+  return *this;
+}
+
+Preconditions& Preconditions::ifUnmodifiedSince(time_t _time) {
+  ifUnmodifiedSinceValue = httpDate(_time);
+  return *this;
+}
+
+bool Preconditions::empty() const {
+  return ifMatchValue.empty() && ifNoneMatchValue.empty()
+      && ifModifiedSinceValue.empty() && ifUnmodifiedSinceValue.empty();
+}
+
+void Preconditions::apply(vector<HTTPHeader> &_reqMap,
+    vector<int> &_validHTTPCodes) const {
+  if (empty())
+    return;
+  if (!ifMatchValue.empty())
+    _reqMap.push_back(HTTPHeader("If-Match", ifMatchValue));
+  if (!ifNoneMatchValue.empty())
+    _reqMap.push_back(HTTPHeader("If-None-Match", ifNoneMatchValue));
+  if (!ifModifiedSinceValue.empty())
+    _reqMap.push_back(HTTPHeader("If-Modified-Since", ifModifiedSinceValue));
+  if (!ifUnmodifiedSinceValue.empty())
+    _reqMap.push_back(
+        HTTPHeader("If-Unmodified-Since", ifUnmodifiedSinceValue));
+  _validHTTPCodes.push_back(HTTPResponse::HTTP_NOT_MODIFIED);
+  _validHTTPCodes.push_back(HTTPResponse::HTTP_PRECONDITION_FAILED);
+}
+
+} /* namespace Swift */
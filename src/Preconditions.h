@@ -0,0 +1,86 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef PRECONDITIONS_H_
+#define PRECONDITIONS_H_
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include "Header.h"
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * Conditional request headers. A request whose condition does not hold
+ * is answered with 304 Not Modified (If-None-Match, If-Modified-Since on
+ * GET/HEAD) or 412 Precondition Failed (If-Match, If-Unmodified-Since, and
+ * If-None-Match on PUT); these come back as SWIFT_NOT_MODIFIED and
+ * SWIFT_PRECONDITION_FAILED instead of SWIFT_HTTP_ERROR.
+ *
+ * Example, create only if absent:
+ * object.swiftCreateReplaceObject(data, size, Preconditions().ifNoneMatchAny());
+ */
+class SWIFTCPP_EXPORT Preconditions {
+private:
+  std::string ifMatchValue;
+  std::string ifNoneMatchValue;
+  std::string ifModifiedSinceValue;
+  std::string ifUnmodifiedSinceValue;
+
+public:
+  /**
+   * Only if the object ETag is _etag
+   */
+  Preconditions& ifMatch(const std::string &_etag);
+
+  /**
+   * Only if the object ETag is not _etag
+   */
+  Preconditions& ifNoneMatch(const std::string &_etag);
+
+  /**
+   * Only if the object does not exist (If-None-Match: *); the one
+   * condition Swift honours on PUT besides If-Match.
+   */
+  Preconditions& ifNoneMatchAny();
+
+  /**
+   * Only if the object changed after _time
+   */
+  Preconditions& ifModifiedSince(std::time_t _time);
+
+  /**
+   * Only if the object did not change after _time
+   */
+  Preconditions& ifUnmodifiedSince(std::time_t _time);
+
+  bool empty() const;
+
+  /**
+   * Adds the headers to _reqMap and 304/412 to _validHTTPCodes, so
+   * doSwiftTransaction reports them as outcomes.
+   */
+  void apply(std::vector<HTTPHeader> &_reqMap,
+      std::vector<int> &_validHTTPCodes) const;
+};
+
+} /* namespace Swift */
+#endif /* PRECONDITIONS_H_ */
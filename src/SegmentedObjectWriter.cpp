@@ -0,0 +1,244 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+
+#include "SegmentedObjectWriter.h"
+#include "HTTPIO.h"
+#include <Poco/Timestamp.h>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * Result of one background segment upload
+ */
+struct SegmentUpload {
+  uint64_t index;
+  SwiftError error;
+  string etag;
+  SegmentUpload(uint64_t _index, const SwiftError &_error, const string &_etag) :
+      index(_index), error(_error), etag(_etag) {
+  }
+};
+
+class SegmentStreamBuf: public streambuf {
+  Object object;
+  Container *segmentContainer;
+  ManifestType manifestType;
+  TransferOptions options;
+  vector<HTTPHeader> reqMap;
+  bool hasReqMap;
+
+  string prefix;
+  vector<char> current;
+  vector<SLOSegment> segments;
+  deque<future<SegmentUpload> > inFlight;
+  uint64_t bytesWritten;
+  bool failed;
+  SwiftError error;
+
+  string segmentName(uint64_t _index) {
+    ostringstream nameStream;
+    nameStream << prefix << setw(8) << setfill('0') << _index;
+    return nameStream.str();
+  }
+
+  /**
+   * Collects the oldest background upload
+   */
+  void waitOldest() {
+    SegmentUpload upload = inFlight.front().get();
+    inFlight.pop_front();
+    if (upload.error.code != SWIFT_OK.code) {
+      if (!failed)
+        error = upload.error;
+      failed = true;
+    } else
+      segments[upload.index].etag = upload.etag;
+  }
+
+  /**
+   * Hands the current segment to a background upload
+   */
+  void flushSegment() {
+    uint64_t length = pptr() - pbase();
+    if (length == 0 || failed)
+      return;
+    bytesWritten += length;
+    shared_ptr<vector<char> > data = make_shared<vector<char> >(
+        std::move(current));
+    data->resize(length);
+    current = vector<char>(options.partSize);
+    setp(current.data(), current.data() + current.size());
+
+    uint64_t index = segments.size();
+    SLOSegment segment;
+    segment.path = "/" + segmentContainer->getName() + "/" + segmentName(index);
+    segment.size = length;
+    segments.push_back(segment);
+
+    while (inFlight.size() >= max<uint32_t>(options.parallelism, 1))
+      waitOldest();
+
+    Object target(segmentContainer, segmentName(index));
+    uint32_t retries = options.retries;
+    inFlight.push_back(async(launch::async, [target, data, index, retries]() mutable {
+      SwiftError uploadError = SWIFT_OK;
+      string etag;
+      for (uint32_t attempt = 0; attempt <= retries; attempt++) {
+        SwiftResult<int*> *result = target.swiftCreateReplaceObject(
+            data->data(), data->size(), true);
+        uploadError = result->getError();
+        if (uploadError.code == SWIFT_OK.code)
+          etag = normalizeETag(result->getResponse()->get("ETag", ""));
+        delete result;
+        if (uploadError.code == SWIFT_OK.code)
+          break;
+      }
+      return SegmentUpload(index, uploadError, etag);
+    }));
+  }
+
+protected:
+  int overflow(int _c) {
+    if (failed || current.empty())
+      return traits_type::eof();
+    flushSegment();
+    if (failed)
+      return traits_type::eof();
+    if (_c != traits_type::eof()) {
+      *pptr() = traits_type::to_char_type(_c);
+      pbump(1);
+    }
+    return traits_type::not_eof(_c);
+  }
+
+public:
+  SegmentStreamBuf(const Object &_object, Container &_segmentContainer,
+      ManifestType _manifestType, const TransferOptions &_options,
+      vector<HTTPHeader> *_reqMap) :
+      object(_object), segmentContainer(&_segmentContainer), manifestType(
+          _manifestType), options(_options), hasReqMap(_reqMap != nullptr), bytesWritten(
+          0), failed(false), error(SWIFT_OK) {
+    if (_reqMap != nullptr)
+      reqMap = *_reqMap;
+    if (options.partSize == 0 || options.partSize > TransferOptions::MAX_OBJECT_SIZE)
+      options.partSize = TransferOptions().partSize;
+    ostringstream prefixStream;
+    prefixStream << object.getName() << "/stream/"
+        << Timestamp().epochMicroseconds() << "/";
+    prefix = prefixStream.str();
+    current = vector<char>(options.partSize);
+    setp(current.data(), current.data() + current.size());
+  }
+
+  ~SegmentStreamBuf() {
+    for (future<SegmentUpload> &upload : inFlight)
+      upload.wait();
+  }
+
+  SwiftResult<int*>* close() {
+    flushSegment();
+    while (!inFlight.empty())
+      waitOldest();
+    current.clear();
+    setp(nullptr, nullptr);
+
+    if (failed) {
+      //Best effort removal of the segments which made it
+      for (uint64_t i = 0; i < segments.size(); i++)
+        if (!segments[i].etag.empty()) {
+          Object segment(segmentContainer, segmentName(i));
+          delete segment.swiftDeleteObject();
+        }
+      SwiftResult<int*> *result = new SwiftResult<int*>();
+      result->setError(error);
+      result->setPayload(nullptr);
+      return result;
+    }
+
+    vector<HTTPHeader> *manifestReqMap = hasReqMap ? &reqMap : nullptr;
+    if (manifestType == ManifestType::DLO)
+      return object.swiftCreateDLOManifest(*segmentContainer, prefix,
+          manifestReqMap);
+    //An SLO needs at least one segment; nothing was written
+    if (segments.empty())
+      return object.swiftCreateReplaceObject("", 0, true, nullptr,
+          manifestReqMap);
+    return object.swiftCreateSLOManifest(segments, manifestReqMap);
+  }
+
+  uint64_t getBytesWritten() const {
+    return bytesWritten + (pptr() - pbase());
+  }
+
+  uint64_t getNumSegments() const {
+    return segments.size();
+  }
+};
+
+SegmentedObjectWriter::SegmentedObjectWriter(const Object &_object,
+    Container &_segmentContainer, ManifestType _manifestType,
+    const TransferOptions &_options, vector<HTTPHeader> *_reqMap) :
+    ostream(nullptr), buffer(
+        new SegmentStreamBuf(_object, _segmentContainer, _manifestType,
+            _options, _reqMap)), closed(false) {
+  rdbuf(buffer);
+}
+
+SegmentedObjectWriter::~SegmentedObjectWriter() {
+  if (!closed)
+    delete close();
+  delete buffer;
+  buffer = nullptr;
+}
+
+SwiftResult<int*>* SegmentedObjectWriter::close() {
+  if (closed) {
+    SwiftResult<int*> *result = new SwiftResult<int*>();
+    result->setError(SwiftError(SwiftError::SWIFT_FAIL, "Writer is closed"));
+    result->setPayload(nullptr);
+    return result;
+  }
+  closed = true;
+  SwiftResult<int*> *result = buffer->close();
+  if (result->getError().code != SWIFT_OK.code)
+    setstate(ios_base::badbit);
+  return result;
+}
+
+uint64_t SegmentedObjectWriter::getBytesWritten() const {
+  return buffer->getBytesWritten();
+}
+
+uint64_t SegmentedObjectWriter::getNumSegments() const {
+  return buffer->getNumSegments();
+}
+
+} /* namespace Swift */
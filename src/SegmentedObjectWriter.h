@@ -0,0 +1,107 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+
+#ifndef SEGMENTEDOBJECTWRITER_H_
+#define SEGMENTEDOBJECTWRITER_H_
+
+#include "Object.h"
+#include "swiftcpp_export.h"
+
+#include <ostream>
+
+namespace Swift {
+
+class SegmentStreamBuf;
+
+/**
+ * Large object manifest written when a SegmentedObjectWriter is closed
+ */
+enum class ManifestType {
+  /**
+   * Dynamic Large Object; X-Object-Manifest pointing at the segment prefix
+   */
+  DLO,
+  /**
+   * Static Large Object; list of segments with their ETags
+   */
+  SLO
+};
+
+/**
+ * An output stream for objects of unbounded size. Written data is cut
+ * into segments of _options.partSize bytes; each full segment is uploaded
+ * to the segment container in the background while the caller keeps
+ * writing, with at most _options.parallelism segments in flight. close()
+ * uploads the last segment and writes the manifest.
+ *
+ * Example:
+ * SegmentedObjectWriter writer(object, segmentContainer);
+ * writer << mydata;
+ * SwiftResult<int*> *result = writer.close();
+ *
+ * If a segment upload fails, the stream goes bad and close() returns the
+ * error.
+ */
+class SWIFTCPP_EXPORT SegmentedObjectWriter: public std::ostream {
+private:
+  SegmentStreamBuf *buffer;
+  bool closed;
+
+public:
+  /**
+   * _object
+   *  The object to create or replace; its Container must outlive the writer.
+   * _segmentContainer
+   *  Existing container which receives the segments
+   *  (<name>/stream/<timestamp>/<index>).
+   * _reqMap
+   *  Headers of the manifest PUT, e.g. Content-Type or metadata.
+   */
+  SegmentedObjectWriter(const Object &_object, Container &_segmentContainer,
+      ManifestType _manifestType = ManifestType::SLO,
+      const TransferOptions &_options = TransferOptions(),
+      std::vector<HTTPHeader> *_reqMap = nullptr);
+
+  /**
+   * Closes the writer if close() was not called
+   */
+  virtual ~SegmentedObjectWriter();
+
+  /**
+   * Uploads the remaining data, waits for all segments and writes the
+   * manifest.
+   * @return
+   *  Result of the manifest PUT, or the first segment error.
+   */
+  SwiftResult<int*>* close();
+
+  /**
+   * Number of bytes written so far
+   */
+  uint64_t getBytesWritten() const;
+
+  /**
+   * Number of segments started so far
+   */
+  uint64_t getNumSegments() const;
+};
+
+} /* namespace Swift */
+#endif /* SEGMENTEDOBJECTWRITER_H_ */
@@ -0,0 +1,439 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "SessionPool.h"
+#include "HTTPIO.h"
+#include <Poco/Exception.h>
+#include <Poco/MD5Engine.h>
+#include <Poco/Net/Socket.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace Swift {
+
+/**
+ * Unbuffered stream buffer which hashes every byte on its way to another
+ * stream, so hashing adds no latency before the bytes reach the socket.
+ */
+class HashingStreamBuf: public streambuf {
+  DigestEngine &digest;
+  ostream &target;
+
+protected:
+  int overflow(int _c) {
+    if (_c == traits_type::eof())
+      return traits_type::not_eof(_c);
+    char c = traits_type::to_char_type(_c);
+    digest.update(c);
+    target.put(c);
+    return target.good() ? _c : traits_type::eof();
+  }
+
+  streamsize xsputn(const char* _s, streamsize _n) {
+    digest.update(_s, _n);
+    target.write(_s, _n);
+    return target.good() ? _n : 0;
+  }
+
+  int sync() {
+    target.flush();
+    return target.good() ? 0 : -1;
+  }
+
+public:
+  HashingStreamBuf(DigestEngine &_digest, ostream &_target) :
+      digest(_digest), target(_target) {
+  }
+};
+
+class HashingOutputStream: public ostream {
+  HashingStreamBuf buffer;
+public:
+  HashingOutputStream(DigestEngine &_digest, ostream &_target) :
+      ostream(nullptr), buffer(_digest, _target) {
+    rdbuf(&buffer);
+  }
+};
+
+/**
+ * Older Poco releases lack this status in HTTPResponse::HTTPStatus
+ */
+static const HTTPResponse::HTTPStatus HTTP_UNPROCESSABLE_ENTITY =
+    (HTTPResponse::HTTPStatus) 422;
+
+PooledHTTPClientSession::PooledHTTPClientSession(const URI& _uri,
+    const string& _poolKey) :
+    HTTPClientSession(_uri.getHost(), _uri.getPort()), poolKey(_poolKey), responseStream(
+        nullptr), responseKeepAlive(false), responseConsumed(false), uploadDigest(
+        nullptr), hashingStream(nullptr), earlyResponseReceived(false) {
+}
+
+PooledHTTPClientSession::~PooledHTTPClientSession() {
+  resetUploadDigest();
+}
+
+void PooledHTTPClientSession::resetUploadDigest() {
+  delete hashingStream;
+  hashingStream = nullptr;
+  delete uploadDigest;
+  uploadDigest = nullptr;
+}
+
+ostream& PooledHTTPClientSession::sendRequest(HTTPRequest& request) {
+  responseStream = nullptr;
+  responseKeepAlive = false;
+  responseConsumed = false;
+  earlyResponseReceived = false;
+  responseCallback = nullptr;
+  resetUploadDigest();
+  return HTTPClientSession::sendRequest(request);
+}
+
+istream& PooledHTTPClientSession::receiveResponse(HTTPResponse& response) {
+  if (hashingStream != nullptr)
+    hashingStream->flush();
+  //HTTPClientSession reads nothing more once peekResponse() got a final
+  //response; it only sets up the body stream from the headers passed in
+  bool early = earlyResponseReceived;
+  if (early) {
+    response.clear();
+    response.setVersion(earlyResponse.getVersion());
+    response.setStatusAndReason(earlyResponse.getStatus(),
+        earlyResponse.getReason());
+    for (NameValueCollection::ConstIterator it = earlyResponse.begin();
+        it != earlyResponse.end(); ++it)
+      response.add(it->first, it->second);
+    earlyResponseReceived = false;
+  }
+  istream &stream = HTTPClientSession::receiveResponse(response);
+  responseStream = &stream;
+  //The server may still wait for the body it was announced
+  responseKeepAlive = !early && response.getKeepAlive();
+
+  if (uploadDigest != nullptr && response.getStatus() >= 200
+      && response.getStatus() < 300 && response.has("ETag")) {
+    string sent = DigestEngine::digestToHex(uploadDigest->digest());
+    string stored = normalizeETag(response.get("ETag"));
+    if (sent != stored)
+      response.setStatusAndReason(HTTP_UNPROCESSABLE_ENTITY,
+          "ETag mismatch: sent " + sent + ", server stored " + stored);
+  }
+  if (responseCallback) {
+    function<void(const HTTPResponse&)> callback;
+    callback.swap(responseCallback);
+    callback(response);
+  }
+  return stream;
+}
+
+void PooledHTTPClientSession::onResponse(
+    const function<void(const HTTPResponse&)> &_callback) {
+  responseCallback = _callback;
+}
+
+DigestEngine& PooledHTTPClientSession::verifyUploadETag() {
+  resetUploadDigest();
+  uploadDigest = new MD5Engine();
+  return *uploadDigest;
+}
+
+ostream& PooledHTTPClientSession::hashRequestBody(ostream &_requestStream) {
+  DigestEngine &digest = verifyUploadETag();
+  hashingStream = new HashingOutputStream(digest, _requestStream);
+  return *hashingStream;
+}
+
+bool PooledHTTPClientSession::waitForContinue(const Timespan &_timeout) {
+  //Servers which ignore the expectation wait for the body in silence
+  if (!socket().poll(_timeout, Socket::SELECT_READ))
+    return true;
+  if (peekResponse(earlyResponse))
+    return true;
+  earlyResponseReceived = true;
+  return false;
+}
+
+int PooledHTTPClientSession::readResponseBody(char *_buffer,
+    streamsize _length) {
+  //Serves what was read ahead with the headers, then reads the socket
+  return read(_buffer, _length);
+}
+
+void PooledHTTPClientSession::endResponseBody(bool _complete) {
+  if (_complete)
+    responseConsumed = true;
+  else
+    responseKeepAlive = false;
+}
+
+bool PooledHTTPClientSession::isResponseConsumed() const {
+  return responseConsumed;
+}
+
+const string& PooledHTTPClientSession::getPoolKey() const {
+  return poolKey;
+}
+
+istream* PooledHTTPClientSession::getResponseStream() const {
+  return responseStream;
+}
+
+bool PooledHTTPClientSession::isResponseKeepAlive() const {
+  return responseKeepAlive;
+}
+
+Timestamp& PooledHTTPClientSession::getLastUsed() {
+  return lastUsed;
+}
+
+/** Pool state **/
+typedef map<string, vector<PooledHTTPClientSession*> > SessionMap;
+
+/**
+ * Idle sessions and settings, all guarded by poolMutex; code running
+ * outside the lock works on copies of the settings.
+ */
+struct PoolState {
+  mutex poolMutex;
+  SessionMap idleSessions;
+  uint32_t maxSessionsPerHost = 16;
+  Timespan idleTimeout = Timespan(8, 0);
+  uint64_t maxDrainBytes = 64 * 1024;
+  atomic<uint64_t> hits;
+  atomic<uint64_t> misses;
+
+  PoolState() :
+      hits(0), misses(0) {
+  }
+
+  ~PoolState() {
+    for (SessionMap::iterator it = idleSessions.begin();
+        it != idleSessions.end(); ++it)
+      for (PooledHTTPClientSession* session : it->second)
+        delete session;
+    idleSessions.clear();
+  }
+};
+
+static PoolState pool;
+
+static string poolKeyOf(const URI &_uri) {
+  return _uri.getScheme() + "://" + _uri.getHost() + ":"
+      + to_string(_uri.getPort());
+}
+
+/**
+ * A kept-alive connection should have nothing to read; if the socket is
+ * readable the server either closed it or sent garbage.
+ */
+static bool isHealthy(PooledHTTPClientSession* _session) {
+  try {
+    if (!_session->connected())
+      return false;
+    return !_session->socket().poll(Timespan(0), Socket::SELECT_READ);
+  } catch (Exception &e) {
+    return false;
+  }
+}
+
+/**
+ * Reads whatever the caller left of the response body, up to about
+ * _maxDrainBytes, so the next request starts on a clean connection.
+ */
+static bool drainResponse(PooledHTTPClientSession* _session,
+    uint64_t _maxDrainBytes) {
+  //The stream does not know the body was read around it
+  if (_session->isResponseConsumed())
+    return true;
+  istream* stream = _session->getResponseStream();
+  if (stream == nullptr)
+    return false;
+  if (stream->eof())
+    return !stream->bad();
+  try {
+    uint64_t drained = 0;
+    char buf[4096];
+    while (stream->good() && drained <= _maxDrainBytes) {
+      stream->read(buf, sizeof(buf));
+      drained += stream->gcount();
+    }
+  } catch (Exception &e) {
+    return false;
+  }
+  return stream->eof() && !stream->bad();
+}
+
+PooledHTTPClientSession* HTTPSessionPool::acquire(const URI& _uri) {
+  string key = poolKeyOf(_uri);
+  vector<PooledHTTPClientSession*> stale;
+  PooledHTTPClientSession* session = nullptr;
+  Timespan idleTimeout;
+  {
+    lock_guard<mutex> guard(pool.poolMutex);
+    idleTimeout = pool.idleTimeout;
+    SessionMap::iterator it = pool.idleSessions.find(key);
+    if (it != pool.idleSessions.end()) {
+      //Most recently used first; it is the most likely one to be alive
+      while (!it->second.empty() && session == nullptr) {
+        PooledHTTPClientSession* candidate = it->second.back();
+        it->second.pop_back();
+        if (candidate->getLastUsed().isElapsed(
+            idleTimeout.totalMicroseconds()))
+          stale.push_back(candidate);
+        else
+          session = candidate;
+      }
+    }
+  }
+
+  //Health check outside the lock
+  for (PooledHTTPClientSession* candidate : stale)
+    delete candidate;
+  if (session != nullptr && !isHealthy(session)) {
+    delete session;
+    session = nullptr;
+  }
+
+  if (session != nullptr) {
+    pool.hits++;
+    return session;
+  }
+
+  pool.misses++;
+  session = new PooledHTTPClientSession(_uri, key);
+  session->setKeepAlive(true);
+  session->setKeepAliveTimeout(idleTimeout);
+  return session;
+}
+
+void HTTPSessionPool::release(HTTPClientSession* _session) {
+  if (_session == nullptr)
+    return;
+  PooledHTTPClientSession* session =
+      dynamic_cast<PooledHTTPClientSession*>(_session);
+  uint64_t maxDrainBytes;
+  {
+    lock_guard<mutex> guard(pool.poolMutex);
+    maxDrainBytes = pool.maxDrainBytes;
+  }
+  if (session == nullptr || session->networkException() != nullptr
+      || !session->isResponseKeepAlive()
+      || !drainResponse(session, maxDrainBytes)) {
+    delete _session;
+    return;
+  }
+
+  session->getLastUsed().update();
+  {
+    lock_guard<mutex> guard(pool.poolMutex);
+    vector<PooledHTTPClientSession*> &idle =
+        pool.idleSessions[session->getPoolKey()];
+    if (idle.size() < pool.maxSessionsPerHost) {
+      idle.push_back(session);
+      return;
+    }
+  }
+  delete session;
+}
+
+void HTTPSessionPool::setMaxSessionsPerHost(uint32_t _max) {
+  lock_guard<mutex> guard(pool.poolMutex);
+  pool.maxSessionsPerHost = _max;
+}
+
+uint32_t HTTPSessionPool::getMaxSessionsPerHost() {
+  lock_guard<mutex> guard(pool.poolMutex);
+  return pool.maxSessionsPerHost;
+}
+
+void HTTPSessionPool::setIdleTimeout(const Timespan& _timeout) {
+  lock_guard<mutex> guard(pool.poolMutex);
+  pool.idleTimeout = _timeout;
+}
+
+Timespan HTTPSessionPool::getIdleTimeout() {
+  lock_guard<mutex> guard(pool.poolMutex);
+  return pool.idleTimeout;
+}
+
+void HTTPSessionPool::setMaxDrainBytes(uint64_t _max) {
+  lock_guard<mutex> guard(pool.poolMutex);
+  pool.maxDrainBytes = _max;
+}
+
+void HTTPSessionPool::evictIdle() {
+  vector<PooledHTTPClientSession*> stale;
+  {
+    lock_guard<mutex> guard(pool.poolMutex);
+    for (SessionMap::iterator it = pool.idleSessions.begin();
+        it != pool.idleSessions.end(); ++it) {
+      vector<PooledHTTPClientSession*> &idle = it->second;
+      for (size_t i = 0; i < idle.size();)
+        if (idle[i]->getLastUsed().isElapsed(
+            pool.idleTimeout.totalMicroseconds())) {
+          stale.push_back(idle[i]);
+          idle.erase(idle.begin() + i);
+        } else
+          i++;
+    }
+  }
+  for (PooledHTTPClientSession* session : stale)
+    delete session;
+}
+
+void HTTPSessionPool::clear() {
+  vector<PooledHTTPClientSession*> idle;
+  {
+    lock_guard<mutex> guard(pool.poolMutex);
+    for (SessionMap::iterator it = pool.idleSessions.begin();
+        it != pool.idleSessions.end(); ++it)
+      idle.insert(idle.end(), it->second.begin(), it->second.end());
+    pool.idleSessions.clear();
+  }
+  for (PooledHTTPClientSession* session : idle)
+    delete session;
+}
+
+uint64_t HTTPSessionPool::getHits() {
+  return pool.hits;
+}
+
+uint64_t HTTPSessionPool::getMisses() {
+  return pool.misses;
+}
+
+uint32_t HTTPSessionPool::getIdleSessions() {
+  lock_guard<mutex> guard(pool.poolMutex);
+  uint32_t count = 0;
+  for (SessionMap::iterator it = pool.idleSessions.begin();
+      it != pool.idleSessions.end(); ++it)
+    count += it->second.size();
+  return count;
+}
+
+} /* namespace Swift */
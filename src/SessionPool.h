@@ -0,0 +1,226 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef SESSIONPOOL_H_
+#define SESSIONPOOL_H_
+
+#include <Poco/Net/HTTPClientSession.h>
+#include <Poco/Net/HTTPRequest.h>
+#include <Poco/Net/HTTPResponse.h>
+#include <Poco/DigestEngine.h>
+#include <Poco/Timespan.h>
+#include <Poco/Timestamp.h>
+#include <Poco/URI.h>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * An HTTPClientSession which remembers where it came from so it can be
+ * handed back to HTTPSessionPool once its result is released.
+ */
+class SWIFTCPP_EXPORT PooledHTTPClientSession: public Poco::Net::HTTPClientSession {
+  /**
+   * scheme://host:port this session is connected to
+   */
+  std::string poolKey;
+
+  /**
+   * Body stream of the last response, nullptr while a request is in flight
+   */
+  std::istream* responseStream;
+
+  /**
+   * Whether the server agreed to keep the connection open
+   */
+  bool responseKeepAlive;
+
+  /**
+   * Whether the response body was read with readResponseBody()
+   */
+  bool responseConsumed;
+
+  /**
+   * Last time this session was returned to the pool
+   */
+  Poco::Timestamp lastUsed;
+
+  /**
+   * MD5 of the request body when its ETag is verified, otherwise nullptr
+   */
+  Poco::DigestEngine* uploadDigest;
+
+  /**
+   * Stream which feeds uploadDigest while forwarding to the request stream
+   */
+  std::ostream* hashingStream;
+
+  /**
+   * Final response which arrived instead of 100 Continue, handed out by
+   * the next receiveResponse()
+   */
+  Poco::Net::HTTPResponse earlyResponse;
+  bool earlyResponseReceived;
+
+  /**
+   * Called once by the next receiveResponse()
+   */
+  std::function<void(const Poco::Net::HTTPResponse&)> responseCallback;
+
+  void resetUploadDigest();
+
+public:
+  PooledHTTPClientSession(const Poco::URI &_uri, const std::string &_poolKey);
+  virtual ~PooledHTTPClientSession();
+
+  std::ostream& sendRequest(Poco::Net::HTTPRequest& request);
+  std::istream& receiveResponse(Poco::Net::HTTPResponse& response);
+
+  /**
+   * Makes receiveResponse() compare the ETag of a successful response with
+   * the MD5 of the request body. On mismatch the response is turned into
+   * 422 Unprocessable Entity, the answer Swift gives to a wrong ETag
+   * header. Call after sendRequest(); every body byte must go through the
+   * returned engine.
+   */
+  Poco::DigestEngine& verifyUploadETag();
+
+  /**
+   * Same as verifyUploadETag() for bodies written by the caller: returns a
+   * stream owned by this session which hashes the bytes as they pass on
+   * to _requestStream.
+   */
+  std::ostream& hashRequestBody(std::ostream &_requestStream);
+
+  /**
+   * After sendRequest() of a request with Expect: 100-continue, waits up
+   * to _timeout for the server to answer before the body goes out.
+   * @return
+   *  true if the body should be sent: the server answered 100 Continue or
+   *  stayed silent. false if a final response (401, 412, 413...) came
+   *  first; the body must not be sent, receiveResponse() returns that
+   *  response and the connection is closed on release.
+   */
+  bool waitForContinue(const Poco::Timespan &_timeout);
+
+  /**
+   * Calls _callback with the response of the request in flight once
+   * receiveResponse() got it, for requests whose response is read by the
+   * caller. Cleared by the next sendRequest().
+   */
+  void onResponse(
+      const std::function<void(const Poco::Net::HTTPResponse&)> &_callback);
+
+  /**
+   * Reads up to _length bytes of the response body straight from the
+   * socket into _buffer, bypassing the response stream and its buffer.
+   * Only valid for bodies with a Content-Length and no transfer encoding,
+   * before anything was read from the response stream; the caller must
+   * not read past Content-Length.
+   * @return
+   *  Number of bytes read, 0 if the connection was closed.
+   */
+  int readResponseBody(char *_buffer, std::streamsize _length);
+
+  /**
+   * Ends a readResponseBody() transfer. A complete body leaves the
+   * connection reusable; an incomplete one gets it closed on release.
+   */
+  void endResponseBody(bool _complete);
+
+  bool isResponseConsumed() const;
+
+  const std::string& getPoolKey() const;
+  std::istream* getResponseStream() const;
+  bool isResponseKeepAlive() const;
+  Poco::Timestamp& getLastUsed();
+};
+
+/**
+ * Keep-alive connection pool used by doHTTPIO. Sessions are keyed by
+ * scheme/host/port; a session goes back to the pool when the SwiftResult
+ * holding it is deleted, provided its response body can be drained.
+ */
+class SWIFTCPP_EXPORT HTTPSessionPool {
+private:
+  HTTPSessionPool() {}
+  ~HTTPSessionPool() {}
+
+public:
+  /**
+   * Returns an idle, healthy session for this uri or creates a new one.
+   */
+  static PooledHTTPClientSession* acquire(const Poco::URI &_uri);
+
+  /**
+   * Gives a session back to the pool. Sessions which cannot be reused
+   * (not from the pool, broken, undrained body, pool full) are deleted.
+   */
+  static void release(Poco::Net::HTTPClientSession* _session);
+
+  /**
+   * Maximum number of idle sessions kept per scheme/host/port (default 16).
+   * Zero disables pooling.
+   */
+  static void setMaxSessionsPerHost(uint32_t _max);
+  static uint32_t getMaxSessionsPerHost();
+
+  /**
+   * Idle sessions older than this are closed (default 8 seconds).
+   */
+  static void setIdleTimeout(const Poco::Timespan &_timeout);
+  static Poco::Timespan getIdleTimeout();
+
+  /**
+   * Maximum number of unread response bytes drained on release before
+   * the session is closed instead of reused (default 64KB).
+   */
+  static void setMaxDrainBytes(uint64_t _max);
+
+  /**
+   * Closes idle sessions which passed the idle timeout.
+   */
+  static void evictIdle();
+
+  /**
+   * Closes all idle sessions.
+   */
+  static void clear();
+
+  /**
+   * Number of times an idle session was reused
+   */
+  static uint64_t getHits();
+
+  /**
+   * Number of times a new session had to be created
+   */
+  static uint64_t getMisses();
+
+  /**
+   * Number of idle sessions currently held by the pool
+   */
+  static uint32_t getIdleSessions();
+};
+
+} /* namespace Swift */
+#endif /* SESSIONPOOL_H_ */
@@ -0,0 +1,174 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "StatCache.h"
+#include <strings.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+using namespace std;
+using namespace Poco::Net;
+
+namespace Swift {
+
+static const string OBJECT_META_PREFIX = "X-Object-Meta-";
+
+void ObjectStat::parse(const HTTPResponse &_response) {
+  exists = true;
+  length = 0;
+  metadata.clear();
+  headers.clear();
+  for (NameValueCollection::ConstIterator it = _response.begin();
+      it != _response.end(); ++it) {
+    headers.push_back(*it);
+    if (strcasecmp(it->first.c_str(), "Content-Length") == 0)
+      length = strtoull(it->second.c_str(), nullptr, 10);
+    else if (strcasecmp(it->first.c_str(), "Content-Type") == 0)
+      contentType = it->second;
+    else if (strcasecmp(it->first.c_str(), "Etag") == 0)
+      etag = it->second;
+    else if (strcasecmp(it->first.c_str(), "Last-Modified") == 0)
+      lastModified = it->second;
+    else if (it->first.size() > OBJECT_META_PREFIX.size()
+        && strncasecmp(it->first.c_str(), OBJECT_META_PREFIX.c_str(),
+            OBJECT_META_PREFIX.size()) == 0)
+      metadata[it->first.substr(OBJECT_META_PREFIX.size())] = it->second;
+  }
+}
+
+void ObjectStat::toResponse(HTTPResponse &_response) const {
+  if (!exists) {
+    _response.setStatusAndReason(HTTPResponse::HTTP_NOT_FOUND);
+    return;
+  }
+  _response.setStatusAndReason(HTTPResponse::HTTP_OK);
+  for (const pair<string, string> &header : headers)
+    _response.add(header.first, header.second);
+}
+
+StatCache::StatCache(chrono::milliseconds _positiveTTL,
+    chrono::milliseconds _negativeTTL, uint32_t _numShards,
+    size_t _maxEntries) :
+    shards(new Shard[max<uint32_t>(_numShards, 1)]),
+    numShards(max<uint32_t>(_numShards, 1)), positiveTTL(_positiveTTL),
+    negativeTTL(_negativeTTL),
+    maxEntriesPerShard(max<size_t>(_maxEntries / max<uint32_t>(_numShards, 1), 1)),
+    hits(0), misses(0) {
+}
+
+StatCache::Shard& StatCache::shardOf(const string &_path) {
+  return shards[hash<string>()(_path) % numShards];
+}
+
+bool StatCache::lookup(const string &_path, ObjectStat &_stat) {
+  Shard &shard = shardOf(_path);
+  {
+    lock_guard<mutex> guard(shard.mutex);
+    unordered_map<string, Entry>::iterator it = shard.entries.find(_path);
+    if (it != shard.entries.end()) {
+      if (it->second.expires > chrono::steady_clock::now()) {
+        _stat = it->second.stat;
+        hits++;
+        return true;
+      }
+      shard.entries.erase(it);
+    }
+  }
+  misses++;
+  return false;
+}
+
+void StatCache::store(const string &_path, const ObjectStat &_stat,
+    chrono::milliseconds _ttl, uint64_t _generation) {
+  if (_ttl.count() <= 0)
+    return;
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  Shard &shard = shardOf(_path);
+  lock_guard<mutex> guard(shard.mutex);
+  //Something was written since the HEAD started: its answer may be stale
+  if (shard.generation != _generation)
+    return;
+  if (shard.entries.size() >= maxEntriesPerShard
+      && shard.entries.find(_path) == shard.entries.end()) {
+    //Make room: expired entries first, any entry if none has expired
+    for (unordered_map<string, Entry>::iterator it = shard.entries.begin();
+        it != shard.entries.end();)
+      if (it->second.expires <= now)
+        it = shard.entries.erase(it);
+      else
+        ++it;
+    if (shard.entries.size() >= maxEntriesPerShard)
+      shard.entries.erase(shard.entries.begin());
+  }
+  Entry &entry = shard.entries[_path];
+  entry.stat = _stat;
+  entry.expires = now + _ttl;
+}
+
+uint64_t StatCache::getGeneration(const string &_path) {
+  Shard &shard = shardOf(_path);
+  lock_guard<mutex> guard(shard.mutex);
+  return shard.generation;
+}
+
+void StatCache::storeFound(const string &_path, const HTTPResponse &_response,
+    uint64_t _generation) {
+  ObjectStat stat;
+  stat.parse(_response);
+  store(_path, stat, positiveTTL, _generation);
+}
+
+void StatCache::storeMissing(const string &_path, uint64_t _generation) {
+  store(_path, ObjectStat(), negativeTTL, _generation);
+}
+
+void StatCache::invalidate(const string &_path) {
+  Shard &shard = shardOf(_path);
+  lock_guard<mutex> guard(shard.mutex);
+  shard.entries.erase(_path);
+  shard.generation++;
+}
+
+void StatCache::clear() {
+  for (uint32_t i = 0; i < numShards; i++) {
+    lock_guard<mutex> guard(shards[i].mutex);
+    shards[i].entries.clear();
+    shards[i].generation++;
+  }
+}
+
+uint64_t StatCache::getHits() const {
+  return hits;
+}
+
+uint64_t StatCache::getMisses() const {
+  return misses;
+}
+
+size_t StatCache::size() {
+  size_t total = 0;
+  for (uint32_t i = 0; i < numShards; i++) {
+    lock_guard<mutex> guard(shards[i].mutex);
+    total += shards[i].entries.size();
+  }
+  return total;
+}
+
+} /* namespace Swift */
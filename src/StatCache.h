@@ -0,0 +1,141 @@
+/**************************************************************************
+    This is a general SDK for OpenStack Swift API written in C++
+    Copyright (C) <2014>  <Behrooz Shafiee Sarjaz>
+    This program comes with ABSOLUTELY NO WARRANTY;
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef STATCACHE_H_
+#define STATCACHE_H_
+
+#include <Poco/Net/HTTPResponse.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "swiftcpp_export.h"
+
+namespace Swift {
+
+/**
+ * What a HEAD of an object tells, parsed
+ */
+struct SWIFTCPP_EXPORT ObjectStat {
+  bool exists = false;
+  uint64_t length = 0;
+  std::string contentType;
+  std::string etag;
+  std::string lastModified;
+  /**
+   * User metadata without the X-Object-Meta- prefix
+   */
+  std::map<std::string, std::string> metadata;
+  /**
+   * All response headers, to rebuild the HEAD response
+   */
+  std::vector<std::pair<std::string, std::string> > headers;
+
+  /**
+   * Fills this from a HEAD response
+   */
+  void parse(const Poco::Net::HTTPResponse &_response);
+
+  /**
+   * Writes the status and headers of the HEAD this came from to _response
+   */
+  void toResponse(Poco::Net::HTTPResponse &_response) const;
+};
+
+/**
+ * Object HEAD results of an account, keyed by "container/object" and
+ * spread over shards with a lock each, so concurrent lookups of different
+ * objects rarely wait for each other. Found objects are kept for the
+ * positive TTL, missing ones for the (usually shorter) negative TTL.
+ * Writes through the SDK drop the entries they affect once answered;
+ * changes made by other clients show up once the entry expires.
+ *
+ * A HEAD racing with a write could store the state from before the write
+ * after the write dropped it. Each shard therefore counts invalidations:
+ * take getGeneration() before the HEAD and pass it to storeFound() or
+ * storeMissing(), which ignore the result if the shard was invalidated
+ * meanwhile.
+ */
+class SWIFTCPP_EXPORT StatCache {
+private:
+  struct Entry {
+    ObjectStat stat;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    uint64_t generation = 0;
+  };
+
+  std::unique_ptr<Shard[]> shards;
+  uint32_t numShards;
+  std::chrono::milliseconds positiveTTL;
+  std::chrono::milliseconds negativeTTL;
+  size_t maxEntriesPerShard;
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+
+  Shard& shardOf(const std::string &_path);
+  void store(const std::string &_path, const ObjectStat &_stat,
+      std::chrono::milliseconds _ttl, uint64_t _generation);
+
+public:
+  StatCache(std::chrono::milliseconds _positiveTTL,
+      std::chrono::milliseconds _negativeTTL, uint32_t _numShards = 16,
+      size_t _maxEntries = 100000);
+
+  /**
+   * @return whether a live entry was found and copied to _stat
+   */
+  bool lookup(const std::string &_path, ObjectStat &_stat);
+
+  /**
+   * Invalidation count of the shard of _path, to take before a HEAD
+   */
+  uint64_t getGeneration(const std::string &_path);
+
+  /**
+   * Remembers a successful HEAD of _path started at _generation
+   */
+  void storeFound(const std::string &_path,
+      const Poco::Net::HTTPResponse &_response, uint64_t _generation);
+
+  /**
+   * Remembers that _path did not exist at _generation
+   */
+  void storeMissing(const std::string &_path, uint64_t _generation);
+
+  void invalidate(const std::string &_path);
+  void clear();
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+  size_t size();
+};
+
+} /* namespace Swift */
+#endif /* STATCACHE_H_ */
@@ -23,7 +23,9 @@
 #include <Poco/Net/HTTPResponse.h>
 #include <Poco/Net/HTTPClientSession.h>
 #include <iostream>
+#include <memory>
 #include "ErrorNo.h"
+#include "SessionPool.h"
 #include <typeinfo>
 #include <type_traits>
 
@@ -36,6 +38,11 @@ class SwiftResult {
   SwiftError error;
   /** Real Data **/
   T payload;
+  /**
+   * Owns a stream payload which is not part of the session, e.g. one
+   * over cached content
+   */
+  std::shared_ptr<void> payloadOwner;
 
 public:
   SwiftResult():response(nullptr), session(nullptr), error(SwiftError::SWIFT_OK,"SWIFT_OK")  {
@@ -47,7 +54,8 @@ public:
       response = nullptr;
     }
     if(session!=nullptr) {
-      delete session;
+      //Hand the connection back for reuse
+      HTTPSessionPool::release(session);
       session = nullptr;
     }
 
@@ -76,6 +84,10 @@ public:
     this->payload = payload;
   }
 
+  void setPayloadOwner(const std::shared_ptr<void> &_owner) {
+    payloadOwner = _owner;
+  }
+
   Poco::Net::HTTPResponse* getResponse() const {
     return response;
   }
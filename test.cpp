@@ -21,9 +21,21 @@
 #include "src/Account.h"
 #include "src/Container.h"
 #include "src/Object.h"
+#include "src/BulkDelete.h"
+#include "src/ContentCache.h"
+#include "src/ListingCache.h"
+#include "src/MetadataSession.h"
+#include "src/ObjectIterator.h"
+#include "src/ObjectListing.h"
+#include "src/SegmentedObjectWriter.h"
+#include "src/SessionPool.h"
 #include <sstream>
 #include <cstring>
 #include <climits>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
 
 using namespace Poco::Net;
 using namespace Poco;
@@ -36,6 +48,39 @@ struct membuf: std::streambuf {
   }
 };
 
+/**
+ * Runs HEAD requests on the same object from a growing number of threads;
+ * with no global transaction lock throughput should grow with threads.
+ */
+void threadScalingTest(Object &_object) {
+  const int durationMs = 3000;
+  cout << "Thread scaling test:" << endl;
+  for (int numThreads = 1; numThreads <= 64; numThreads *= 2) {
+    atomic<uint64_t> numRequests(0);
+    atomic<uint64_t> numErrors(0);
+    atomic<bool> stop(false);
+    vector<thread> workers;
+    for (int i = 0; i < numThreads; i++)
+      workers.push_back(thread([&]() {
+        while (!stop) {
+          SwiftResult<int*>* res = _object.swiftShowMetadata();
+          if (res->getError().code != SWIFT_OK.code)
+            numErrors++;
+          numRequests++;
+          delete res;
+        }
+      }));
+    this_thread::sleep_for(chrono::milliseconds(durationMs));
+    stop = true;
+    for (thread &worker : workers)
+      worker.join();
+    cout << "Threads:" << numThreads << "\tRequests/s:"
+        << numRequests * 1000.0 / durationMs << "\tErrors:" << numErrors
+        << endl;
+  }
+  cout << endl;
+}
+
 int main(int argc, char** argv) {
   AuthenticationInfo info;
   info.username = "admin";
@@ -97,6 +142,13 @@ int main(int argc, char** argv) {
   cout << endl << endl;
   delete accountMetaDataRes;
 
+  //Account statistics from a cached HEAD
+  Account *account = authenticateResult->getPayload();
+  account->setStatsBackgroundRefresh(true);
+  cout << "Bytes used:" << account->getBytesUsed() << "\tObjects:"
+      << account->getObjectCount() << "\tServer time:"
+      << account->getServerTime() << endl << endl;
+
   //List containers
   SwiftResult<vector<Container>*>* containerListRes = authenticateResult->getPayload()->swiftGetContainers();
   cout<<"Num of Container:"<<containerListRes->getPayload()->size()<<endl;;
@@ -128,6 +180,48 @@ int main(int argc, char** argv) {
     }
   delete objects;
 
+  //Lazy paginated listing
+  ObjectIterator objectIterator(&container2, 2);
+  uint64_t listed = 0;
+  while (objectIterator.hasNext()) {
+    objectIterator.next();
+    listed++;
+  }
+  cout << "Iterated " << listed << " objects in "
+      << objectIterator.getPagesFetched() << " pages:"
+      << objectIterator.getError().toString() << endl << endl;
+
+  //Compact listing
+  SwiftResult<ObjectListing*> *listingResult = container2.swiftGetObjectListing();
+  if (listingResult->getError().code == SWIFT_OK.code) {
+    ObjectListing *listing = listingResult->getPayload();
+    cout << "Listing:" << listing->size() << " objects in "
+        << listing->getMemoryUsage() << " bytes" << endl;
+    if (!listing->empty()) {
+      size_t index = listing->find(listing->getName(0));
+      cout << listing->getObject(index).getName() << "\tHash:"
+          << listing->getHashHex(index) << endl;
+    }
+  }
+  cout << endl;
+  delete listingResult;
+
+  //Listing served from the local cache while the container is unchanged
+  ListingCache::setDirectory("/tmp");
+  for (int i = 0; i < 2; i++)
+    delete container2.swiftGetObjectListing();
+  cout << "Listing cache hits:" << ListingCache::getHits() << "\tMisses:"
+      << ListingCache::getMisses() << endl << endl;
+  ListingCache::invalidate(container2);
+  ListingCache::setDirectory("");
+
+  //Parallel listing over sampled partitions
+  listingResult = container2.swiftGetObjectListingParallel(4);
+  if (listingResult->getError().code == SWIFT_OK.code)
+    cout << "Parallel listing:" << listingResult->getPayload()->size()
+        << " objects" << endl << endl;
+  delete listingResult;
+
   //Delete container
   containerRes = container.swiftDeleteContainer();
   containerRes->getResponse()->write(cout);
@@ -146,6 +240,14 @@ int main(int argc, char** argv) {
   cout << endl << endl;
   delete containerResult;
 
+  //List the first level of a pseudo directory, filtered by the server
+  containerResult = container.swiftListObjects(
+      ListingQuery().prefix("Object").delimiter('/').limit(100));
+  if(containerResult->getError().code == SwiftError::SWIFT_OK)
+    StreamCopier::copyStream(*containerResult->getPayload(), cout);
+  cout << endl << endl;
+  delete containerResult;
+
   //Create Container metadata
   vector<pair<string, string> > containerMetaData;
   containerMetaData.push_back(make_pair("Key 1", "Container Value 1"));
@@ -186,6 +288,23 @@ int main(int argc, char** argv) {
   cout << endl << endl;
   delete objResult;
 
+  //Concurrent transactions
+  threadScalingTest(object);
+
+  //Asynchronous requests
+  vector<future<SwiftResult<int*>*> > pending;
+  for (int i = 0; i < 100; i++)
+    pending.push_back(object.swiftShowMetadataAsync());
+  int asyncErrors = 0;
+  for (auto &request : pending) {
+    SwiftResult<int*>* asyncResult = request.get();
+    if (asyncResult->getError().code != SWIFT_OK.code)
+      asyncErrors++;
+    delete asyncResult;
+  }
+  cout << "Async requests:" << pending.size() << "\tErrors:" << asyncErrors
+      << endl << endl;
+
   //Object get content
   SwiftResult<istream*>* objReadResult = object.swiftGetObjectContent();
   if(objReadResult->getError().code == SwiftError::SWIFT_OK)
@@ -221,6 +340,171 @@ int main(int argc, char** argv) {
     readResult->getPayload()->read(buf, bufSize);
   delete readResult;
 
+  //Repeated reads revalidated against the content cache
+  ContentCache::setMemoryLimit(64 * 1024 * 1024);
+  for (int i = 0; i < 3; i++) {
+    SwiftResult<istream*> *cachedRead = object.swiftGetObjectContent();
+    if (cachedRead->getError().code == SwiftError::SWIFT_OK)
+      StreamCopier::copyStream(*cachedRead->getPayload(), cout);
+    cout << endl;
+    delete cachedRead;
+  }
+  cout << "Content cache hits:" << ContentCache::getMemoryHits()
+      << "\tMisses:" << ContentCache::getMisses() << "\tBytes saved:"
+      << ContentCache::getBytesSaved() << endl << endl;
+  //Direct downloads bypass the cache and read the connection themselves
+  vector<char> cachedInto(bufSize);
+  SwiftResult<uint64_t*> *cachedIntoResult = object.swiftGetObjectContentInto(
+      cachedInto.data(), cachedInto.size());
+  if (cachedIntoResult->getError().code == SWIFT_OK.code)
+    cout << "Direct download with cache on:" << *cachedIntoResult->getPayload()
+        << " bytes" << endl << endl;
+  else
+    cout << "Direct download with cache on:"
+        << cachedIntoResult->getError().toString() << endl << endl;
+  delete cachedIntoResult;
+  ContentCache::setMemoryLimit(0);
+  ContentCache::clear();
+
+  //Conditional requests: create if absent, then revalidate by ETag
+  Object conditionalObject(&container, "Conditional Object");
+  string conditionalData = "written once";
+  for (int i = 0; i < 2; i++) {
+    SwiftResult<int*> *createResult = conditionalObject.swiftCreateReplaceObject(
+        conditionalData.c_str(), conditionalData.length(),
+        Preconditions().ifNoneMatchAny());
+    cout << "Create if absent:" << createResult->getError().toString() << endl;
+    delete createResult;
+  }
+  SwiftResult<ObjectStat*> *conditionalStat = conditionalObject.swiftStat();
+  if (conditionalStat->getError().code == SwiftError::SWIFT_OK) {
+    SwiftResult<istream*> *conditionalRead =
+        conditionalObject.swiftGetObjectContent(
+            Preconditions().ifNoneMatch(conditionalStat->getPayload()->etag));
+    cout << "Conditional read:" << conditionalRead->getError().toString()
+        << endl << endl;
+    delete conditionalRead;
+  }
+  delete conditionalStat;
+  delete conditionalObject.swiftDeleteObject();
+
+  //Download straight into our own buffer
+  vector<char> downloadBuf(bufSize);
+  SwiftResult<uint64_t*> *intoResult = chucnkedObject.swiftGetObjectContentInto(
+      downloadBuf.data(), downloadBuf.size());
+  if (intoResult->getError().code == SWIFT_OK.code)
+    cout << "Direct download:" << *intoResult->getPayload() << " bytes" << endl
+        << endl;
+  else
+    cout << "Direct download:" << intoResult->getError().toString() << endl
+        << endl;
+  delete intoResult;
+
+  //Parallel ranged download
+  TransferOptions transferOptions;
+  transferOptions.partSize = 16 * 1024;
+  SwiftResult<uint64_t*> *parallelResult =
+      chucnkedObject.swiftGetObjectContentParallel(downloadBuf.data(),
+          downloadBuf.size(), transferOptions);
+  if (parallelResult->getError().code == SWIFT_OK.code)
+    cout << "Parallel download:" << *parallelResult->getPayload() << " bytes"
+        << endl << endl;
+  else
+    cout << "Parallel download:" << parallelResult->getError().toString()
+        << endl << endl;
+  delete parallelResult;
+
+  //Zero-copy file upload
+  Object fileObject(&container, "File Object");
+  SwiftResult<int*> *fileResult = fileObject.swiftUploadFile("test.cpp");
+  cout << "File upload:" << fileResult->getError().toString() << endl << endl;
+  delete fileResult;
+  delete fileObject.swiftDeleteObject();
+
+  //Pulled body with a known length, sent once the server said 100 Continue
+  setExpectContinueThreshold(4 * 1024);
+  FILE *sourceFile = fopen("test.cpp", "r");
+  if (sourceFile != nullptr) {
+    fseek(sourceFile, 0, SEEK_END);
+    FileBodySource fileBody(fileno(sourceFile), 0, ftell(sourceFile));
+    SwiftResult<int*> *bodyResult = fileObject.swiftCreateReplaceObject(
+        fileBody);
+    cout << "BodySource upload:" << bodyResult->getError().toString() << endl
+        << endl;
+    delete bodyResult;
+    delete fileObject.swiftDeleteObject();
+    fclose(sourceFile);
+  }
+  setExpectContinueThreshold(1024 * 1024);
+
+  //Static Large Object upload
+  Container segmentContainer(authenticateResult->getPayload(),
+      "Container2_segments");
+  delete segmentContainer.swiftCreateContainer();
+  Object sloObject(&container, "SLO Object");
+  string sloData(5 * 1024 * 1024 + 17, 'x');
+  transferOptions.partSize = 1024 * 1024;
+  SwiftResult<int*> *sloResult = sloObject.swiftCreateReplaceObjectSLO(
+      sloData.c_str(), sloData.size(), segmentContainer, transferOptions);
+  cout << "SLO upload:" << sloResult->getError().toString() << endl << endl;
+  delete sloResult;
+  delete sloObject.swiftDeleteObject(true);
+
+  //Auto-segmenting stream writer
+  Object streamedObject(&container, "Streamed Object");
+  SegmentedObjectWriter segmentedWriter(streamedObject, segmentContainer,
+      ManifestType::SLO, transferOptions);
+  for (ulong i = 0; i < max; i++)
+    segmentedWriter << i << "\n";
+  SwiftResult<int*> *segmentedResult = segmentedWriter.close();
+  cout << "Segmented writer:" << segmentedWriter.getBytesWritten()
+      << " bytes in " << segmentedWriter.getNumSegments() << " segments, "
+      << segmentedResult->getError().toString() << endl << endl;
+  delete segmentedResult;
+  delete streamedObject.swiftDeleteObject(true);
+
+  //Purge the segment container with whatever is left in it
+  PurgeOptions purgeOptions;
+  purgeOptions.onProgress = [](const PurgeProgress &_progress) {
+    cout << "Purged " << _progress.objectsDeleted << "/"
+        << _progress.objectsListed << endl;
+  };
+  purgeOptions.onThroughput = [](double _objectsPerSecond, double) {
+    cout << _objectsPerSecond << " objects/s" << endl;
+  };
+  SwiftResult<BulkDeleteResult*> *purgeResult = segmentContainer.swiftPurge(
+      purgeOptions);
+  cout << "Purge:" << purgeResult->getError().toString() << endl << endl;
+  delete purgeResult;
+
+  //Many small objects in one extract-archive request
+  vector<pair<string, string> > archiveEntries;
+  vector<string> bulkNames;
+  for (int i = 0; i < 20; i++) {
+    archiveEntries.push_back(make_pair("Bulk/" + to_string(i), data));
+    bulkNames.push_back("Bulk/" + to_string(i));
+  }
+  SwiftResult<ArchiveUploadResult*> *archiveResult =
+      container.swiftUploadArchive(archiveEntries, true);
+  cout << "Archive upload:" << archiveResult->getError().toString();
+  if (archiveResult->getPayload() != nullptr)
+    cout << "\tCreated:" << archiveResult->getPayload()->created
+        << "\tErrors:" << archiveResult->getPayload()->errors.size();
+  cout << endl << endl;
+  delete archiveResult;
+
+  //Bulk delete
+  bulkNames.push_back("Bulk/missing");
+  SwiftResult<BulkDeleteResult*> *bulkResult = container.swiftBulkDelete(
+      bulkNames);
+  cout << "Bulk delete:" << bulkResult->getError().toString();
+  if (bulkResult->getPayload() != nullptr)
+    cout << "\tDeleted:" << bulkResult->getPayload()->deleted
+        << "\tNot found:" << bulkResult->getPayload()->notFound
+        << "\tErrors:" << bulkResult->getPayload()->errors.size();
+  cout << endl << endl;
+  delete bulkResult;
+
   //Copy Object
   SwiftResult<int*>* copyResult = chucnkedObject.swiftCopyObject(
       "CopyStreamObject", container);
@@ -274,6 +558,14 @@ int main(int argc, char** argv) {
   objMetaRes = chucnkedObject.swiftDeleteMetadata(keysToDelete);
   delete objMetaRes;
 
+  //Several metadata changes in one POST
+  MetadataSession metadataSession(chucnkedObject);
+  metadataSession.set("Tag1", "red").set("Tag2", "blue").remove("Key1");
+  SwiftResult<istream*> *sessionResult = metadataSession.commit();
+  cout << "Metadata session:" << sessionResult->getError().toString()
+      << "\tETag:" << metadataSession.getETag() << endl << endl;
+  delete sessionResult;
+
   //Object show Metadata
   cout << endl << endl << "MetaDataResult:" << endl;
   metaDataShowResult = chucnkedObject.swiftShowMetadata();
@@ -281,9 +573,26 @@ int main(int argc, char** argv) {
   cout << endl << endl;
   delete metaDataShowResult;
 
+  //Repeated stats served from the stat cache, misses included
+  authenticateResult->getPayload()->setStatCache(chrono::seconds(5),
+      chrono::seconds(1));
+  for (int i = 0; i < 3; i++) {
+    delete chucnkedObject.swiftStat();
+    Object missingObject(&container, "Missing Object");
+    delete missingObject.swiftStat();
+  }
+  cout << "Stat cache hits:"
+      << authenticateResult->getPayload()->getStatCache()->getHits()
+      << "\tMisses:"
+      << authenticateResult->getPayload()->getStatCache()->getMisses() << endl
+      << endl;
+  authenticateResult->getPayload()->setStatCache(chrono::milliseconds(0));
+
   //Total number of calls to the api
   cout << "Total Number of Calls to the api:"
       << authenticateResult->getPayload()->getNumberOfCalls() << endl;
+  cout << "Connection pool hits:" << HTTPSessionPool::getHits()
+      << "\tmisses:" << HTTPSessionPool::getMisses() << endl;
 
   delete authenticateResult;
 }